@@ -0,0 +1,380 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#include "audiostream.h"
+#include <QAudioDevice>
+#include <QAudioFormat>
+#include <QAudioSource>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QMediaDevices>
+#include <QTimer>
+#include <QWebSocket>
+#include <QtEndian>
+#include <QDebug>
+#include <vector>
+
+#ifdef HAVE_OPUS
+#include <opus.h>
+#endif
+
+static const int SampleRate = 48000;
+static const int Channels = 2;
+static const int HeaderSize = 20;
+static const int MaxOpusPacket = 1500;
+static const int GeneratorIntervalMs = 10;
+
+enum Codec : quint8 {
+    CodecPcm = 0,
+    CodecOpus = 1,
+};
+
+AudioStream::AudioStream(QObject *parent)
+    : QObject(parent)
+    , m_generatorTimer(new QTimer(this))
+    , m_ring(SampleRate * Channels) // One second of slack
+{
+    m_generatorTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_generatorTimer, &QTimer::timeout, this, &AudioStream::feedGeneratedAudio);
+}
+
+AudioStream::~AudioStream()
+{
+    stopStreaming();
+}
+
+void AudioStream::handleRequest(const QJsonObject &request, QWebSocket *client)
+{
+    QString action = request["action"].toString();
+
+    if (action == "start") {
+        startStreaming(request, client);
+    } else if (action == "stop") {
+        stopStreaming();
+    } else if (action == "list") {
+        listDevices(request, client);
+    } else if (action == "stats") {
+        sendStats(client);
+    }
+}
+
+void AudioStream::clientDisconnected(QWebSocket *client)
+{
+    if (client == m_client) {
+        stopStreaming();
+    }
+}
+
+void AudioStream::reattachClient(QWebSocket *from, QWebSocket *to)
+{
+    // Packets carry sequence numbers, so the client sees what it missed
+    if (from == m_client) {
+        m_client = to;
+    }
+}
+
+static bool isMonitor(const QAudioDevice &device)
+{
+    return device.id().contains(".monitor") || device.description().startsWith("Monitor of");
+}
+
+// The capture device that carries what the default output plays, or a null
+// device. PulseAudio and PipeWire name it after the sink.
+static QAudioDevice defaultOutputMonitor()
+{
+    const QAudioDevice output = QMediaDevices::defaultAudioOutput();
+    if (output.isNull()) {
+        return QAudioDevice();
+    }
+    const QByteArray monitorId = output.id() + ".monitor";
+    const QString monitorName = "Monitor of " + output.description();
+    for (const QAudioDevice &candidate : QMediaDevices::audioInputs()) {
+        if (candidate.id() == monitorId || candidate.description() == monitorName) {
+            return candidate;
+        }
+    }
+    return QAudioDevice();
+}
+
+void AudioStream::listDevices(const QJsonObject &request, QWebSocket *client)
+{
+    const QAudioDevice defaultDevice = defaultOutputMonitor();
+
+    QJsonArray devices;
+    for (const QAudioDevice &device : QMediaDevices::audioInputs()) {
+        QJsonObject info;
+        info["id"] = QString::fromUtf8(device.id());
+        info["description"] = device.description();
+        info["monitor"] = isMonitor(device);
+        info["default"] = !defaultDevice.isNull() && device.id() == defaultDevice.id();
+        devices.append(info);
+    }
+
+    QJsonObject response;
+    response["type"] = "audio";
+    response["action"] = "list";
+    response["id"] = request["id"];
+    response["devices"] = devices;
+    client->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
+}
+
+void AudioStream::startStreaming(const QJsonObject &request, QWebSocket *client)
+{
+    stopStreaming();
+
+    QJsonObject response;
+    response["type"] = "audio";
+    response["id"] = request["id"];
+
+    // 10 or 20 ms frames; shorter frames mean less latency but more packets
+    const int frameMs = request["frameMs"].toInt(20) <= 10 ? 10 : 20;
+    m_frameSamples = SampleRate * frameMs / 1000;
+
+    QAudioFormat format;
+    format.setSampleRate(SampleRate);
+    format.setChannelCount(Channels);
+    format.setSampleFormat(QAudioFormat::Int16);
+
+    // "source" is "default" for the monitor of the default output, "monitor"
+    // for the first output monitor, "null" for silence, "file" for raw 48 kHz
+    // stereo s16le PCM at "path", or a device id. A microphone is only opened
+    // when a client names it by id.
+    const QString source = request["source"].toString("default");
+    if (source == "null") {
+        m_generatorTimer->start(GeneratorIntervalMs);
+    } else if (source == "file") {
+        m_file = std::make_unique<QFile>(request["path"].toString());
+        if (!m_file->open(QIODevice::ReadOnly)) {
+            m_file.reset();
+            response["status"] = "error";
+            response["message"] = "Failed to open audio file";
+            client->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
+            return;
+        }
+        m_generatorTimer->start(GeneratorIntervalMs);
+    } else {
+        QAudioDevice device;
+        if (source == "default") {
+            device = defaultOutputMonitor();
+        } else {
+            for (const QAudioDevice &candidate : QMediaDevices::audioInputs()) {
+                if ((source == "monitor" && isMonitor(candidate)) || candidate.id() == source.toUtf8()) {
+                    device = candidate;
+                    break;
+                }
+            }
+        }
+
+        if (device.isNull() || !device.isFormatSupported(format)) {
+            response["status"] = "error";
+            response["message"] = device.isNull() && source == "default"
+                ? "The default output has no monitor to capture"
+                : "No suitable audio input";
+            client->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
+            return;
+        }
+
+        m_source = std::make_unique<QAudioSource>(device, format);
+        // Keep the device buffer short; the ring buffer absorbs jitter
+        m_source->setBufferSize(format.bytesForDuration(frameMs * 2000));
+        m_device = m_source->start();
+        connect(m_device, &QIODevice::readyRead, this, &AudioStream::readFromDevice);
+        response["device"] = device.description();
+    }
+
+#ifdef HAVE_OPUS
+    if (request["codec"].toString("opus") == "opus") {
+        int error = OPUS_OK;
+        OpusEncoder *encoder = opus_encoder_create(SampleRate, Channels,
+                                                   OPUS_APPLICATION_RESTRICTED_LOWDELAY, &error);
+        if (error == OPUS_OK) {
+            opus_encoder_ctl(encoder, OPUS_SET_BITRATE(request["bitrate"].toInt(96000)));
+            m_opus = encoder;
+        }
+    }
+#endif
+    m_useOpus = m_opus != nullptr;
+
+    m_client = client;
+    m_packets = 0;
+    m_bytes = 0;
+    m_overruns = 0;
+    m_running = true;
+    m_encoderThread = std::thread(&AudioStream::encoderLoop, this);
+
+    response["status"] = "streaming";
+    response["codec"] = m_useOpus ? "opus" : "pcm";
+    response["sampleRate"] = SampleRate;
+    response["channels"] = Channels;
+    response["frameMs"] = frameMs;
+    client->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
+    qDebug() << "Audio streaming started";
+}
+
+void AudioStream::stopStreaming()
+{
+    if (m_running) {
+        m_running = false;
+        m_dataReady.release();
+        m_encoderThread.join();
+        qDebug() << "Audio streaming stopped";
+    }
+
+    m_generatorTimer->stop();
+    m_file.reset();
+    if (m_source) {
+        m_source->stop();
+        m_source.reset();
+        m_device = nullptr;
+    }
+
+#ifdef HAVE_OPUS
+    if (m_opus) {
+        opus_encoder_destroy(static_cast<OpusEncoder *>(m_opus));
+    }
+#endif
+    m_opus = nullptr;
+
+    // Both sides are idle now
+    m_ring.reset();
+    m_dataReady.acquire(m_dataReady.available());
+    m_client = nullptr;
+}
+
+void AudioStream::sendStats(QWebSocket *client)
+{
+    QJsonObject stats;
+    stats["streaming"] = m_running.load();
+    stats["codec"] = m_useOpus ? "opus" : "pcm";
+    stats["packets"] = qint64(m_packets.load());
+    stats["bytes"] = qint64(m_bytes.load());
+    stats["overruns"] = qint64(m_overruns.load());
+    stats["buffered"] = qint64(m_ring.available() / Channels);
+
+    QJsonObject response;
+    response["type"] = "audio";
+    response["action"] = "stats";
+    response["data"] = stats;
+    client->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
+}
+
+void AudioStream::readFromDevice()
+{
+    const qint64 bytes = m_device->bytesAvailable();
+    if (bytes <= 0) {
+        return;
+    }
+    if (m_readBuffer.size() < bytes) {
+        m_readBuffer.resize(bytes);
+    }
+    const qint64 read = m_device->read(m_readBuffer.data(), bytes);
+    if (read > 0) {
+        pushSamples(m_readBuffer.constData(), read);
+    }
+}
+
+void AudioStream::feedGeneratedAudio()
+{
+    const qint64 bytes = qint64(SampleRate) * GeneratorIntervalMs / 1000 * Channels * 2;
+    if (m_readBuffer.size() < bytes) {
+        m_readBuffer.resize(bytes);
+    }
+
+    if (m_file) {
+        qint64 filled = 0;
+        while (filled < bytes) {
+            const qint64 read = m_file->read(m_readBuffer.data() + filled, bytes - filled);
+            if (read <= 0) {
+                // Loop the file; an empty file plays as silence
+                if (m_file->size() == 0 || !m_file->seek(0))
+                    break;
+                continue;
+            }
+            filled += read;
+        }
+        memset(m_readBuffer.data() + filled, 0, bytes - filled);
+    } else {
+        memset(m_readBuffer.data(), 0, bytes);
+    }
+
+    pushSamples(m_readBuffer.constData(), bytes);
+}
+
+void AudioStream::pushSamples(const char *data, qint64 bytes)
+{
+    const size_t samples = size_t(bytes) / sizeof(qint16);
+    const size_t written = m_ring.write(reinterpret_cast<const qint16 *>(data), samples);
+    if (written < samples) {
+        // The encoder fell a second behind; dropping is better than growing latency
+        ++m_overruns;
+    }
+    m_dataReady.release();
+}
+
+void AudioStream::encoderLoop()
+{
+    const size_t frameValues = size_t(m_frameSamples) * Channels;
+    std::vector<qint16> pcm(frameValues);
+    quint32 sequence = 0;
+    quint64 samplesEncoded = 0;
+
+    while (m_running) {
+        if (!m_dataReady.tryAcquire(1, 100)) {
+            continue;
+        }
+
+        while (m_running && m_ring.available() >= frameValues) {
+            m_ring.read(pcm.data(), frameValues);
+
+            const int payloadCapacity = m_useOpus ? MaxOpusPacket : int(frameValues * sizeof(qint16));
+            QByteArray packet(HeaderSize + payloadCapacity, Qt::Uninitialized);
+            uchar *header = reinterpret_cast<uchar *>(packet.data());
+
+            int payloadSize = 0;
+#ifdef HAVE_OPUS
+            if (m_useOpus) {
+                payloadSize = opus_encode(static_cast<OpusEncoder *>(m_opus), pcm.data(), m_frameSamples,
+                                          header + HeaderSize, MaxOpusPacket);
+                if (payloadSize < 0) {
+                    qWarning() << "Opus encoding failed:" << opus_strerror(payloadSize);
+                    continue;
+                }
+            }
+#endif
+            if (!m_useOpus) {
+                for (size_t i = 0; i < frameValues; ++i) {
+                    qToLittleEndian<qint16>(pcm[i], header + HeaderSize + i * sizeof(qint16));
+                }
+                payloadSize = payloadCapacity;
+            }
+            packet.resize(HeaderSize + payloadSize);
+
+            // Timestamps follow the sample clock, so they are free of
+            // scheduling jitter and clients can size their jitter buffer
+            const quint64 timestampUs = samplesEncoded * 1000000 / SampleRate;
+            memcpy(header, "PCRA", 4);
+            header[4] = m_useOpus ? CodecOpus : CodecPcm;
+            header[5] = Channels;
+            qToLittleEndian<quint16>(quint16(m_frameSamples), header + 6);
+            qToLittleEndian<quint32>(sequence++, header + 8);
+            qToLittleEndian<quint64>(timestampUs, header + 12);
+            samplesEncoded += m_frameSamples;
+
+            QMetaObject::invokeMethod(this, [this, packet]() {
+                sendPacket(packet);
+            }, Qt::QueuedConnection);
+        }
+    }
+}
+
+void AudioStream::sendPacket(const QByteArray &packet)
+{
+    // Packets for a client that is about to resume are dropped
+    if (!m_client || !m_client->isValid()) {
+        return;
+    }
+    m_client->sendBinaryMessage(packet);
+    ++m_packets;
+    m_bytes += packet.size();
+}
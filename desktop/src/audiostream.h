@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#pragma once
+
+#include <QObject>
+#include <QJsonObject>
+#include <QSemaphore>
+#include <QElapsedTimer>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include "spscringbuffer.h"
+
+class QAudioSource;
+class QFile;
+class QIODevice;
+class QTimer;
+class QWebSocket;
+
+// Streams captured audio to one client as binary packets. Samples are
+// handed from the capture side to an encoder thread through a lock-free
+// ring buffer; packets go back to the GUI thread only to be sent.
+//
+// Packet layout (little endian):
+//   0  4  magic "PCRA"
+//   4  1  codec: 0 = PCM s16le, 1 = Opus
+//   5  1  channel count
+//   6  2  samples per channel in this packet
+//   8  4  sequence number
+//  12  8  capture timestamp in microseconds since the stream started
+//  20     payload
+class AudioStream : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AudioStream(QObject *parent = nullptr);
+    ~AudioStream();
+
+    void handleRequest(const QJsonObject &request, QWebSocket *client);
+    void clientDisconnected(QWebSocket *client);
+    void reattachClient(QWebSocket *from, QWebSocket *to);
+
+private slots:
+    void readFromDevice();
+    void feedGeneratedAudio();
+
+private:
+    void startStreaming(const QJsonObject &request, QWebSocket *client);
+    void stopStreaming();
+    void listDevices(const QJsonObject &request, QWebSocket *client);
+    void sendStats(QWebSocket *client);
+    void sendPacket(const QByteArray &packet);
+
+    void pushSamples(const char *data, qint64 bytes);
+    void encoderLoop();
+
+    QWebSocket *m_client = nullptr;
+
+    // Either a real capture device or a timer-driven generator that reads a
+    // raw PCM file or produces silence, for machines without sound hardware
+    std::unique_ptr<QAudioSource> m_source;
+    QIODevice *m_device = nullptr;
+    QTimer *m_generatorTimer;
+    std::unique_ptr<QFile> m_file;
+    QByteArray m_readBuffer;
+
+    SpscRingBuffer<qint16> m_ring;
+    QSemaphore m_dataReady;
+    std::thread m_encoderThread;
+    std::atomic<bool> m_running{false};
+
+    int m_frameSamples = 960;
+    bool m_useOpus = false;
+    void *m_opus = nullptr;
+
+    std::atomic<quint64> m_packets{0};
+    std::atomic<quint64> m_bytes{0};
+    std::atomic<quint64> m_overruns{0};
+};
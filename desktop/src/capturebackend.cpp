@@ -0,0 +1,256 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#include "capturebackend.h"
+#include <QGuiApplication>
+#include <QScreen>
+#include <QPixmap>
+#include <QtMath>
+#include <QDebug>
+
+#ifdef HAVE_XSHM
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#endif
+
+QList<CapturedImage> CaptureBackend::grabWindow(quint64 window, const QRect &geometry, const QRect &region)
+{
+    Q_UNUSED(window)
+    return grab(region.translated(geometry.topLeft()));
+}
+
+QList<CapturedImage> QScreenCaptureBackend::grab(const QRect &region)
+{
+    QList<CapturedImage> parts;
+    for (QScreen *screen : QGuiApplication::screens()) {
+        const QRect part = screen->geometry() & region;
+        if (part.isEmpty())
+            continue;
+
+        const QRect local = part.translated(-screen->geometry().topLeft());
+        QImage image = screen->grabWindow(0, local.x(), local.y(),
+                                          local.width(), local.height()).toImage();
+        if (image.isNull())
+            continue;
+
+        parts.append({image, part.translated(-region.topLeft())});
+    }
+    return parts;
+}
+
+#ifdef HAVE_XSHM
+
+// Reads the root window through a shared memory segment that is mapped
+// once and reused, so a frame is never copied through the X socket or
+// into a fresh QPixmap. The returned image points straight at the segment.
+class XShmCaptureBackend : public CaptureBackend
+{
+public:
+    ~XShmCaptureBackend() override;
+
+    bool init();
+    const char *name() const override { return "xshm"; }
+    QList<CapturedImage> grab(const QRect &region) override;
+    QList<CapturedImage> grabWindow(quint64 window, const QRect &geometry, const QRect &region) override;
+
+private:
+    bool ensureImage(int width, int height);
+    void releaseSegment();
+
+    Display *m_display = nullptr;
+    XShmSegmentInfo m_shm = {};
+    XImage *m_image = nullptr;
+    size_t m_segmentSize = 0;
+};
+
+XShmCaptureBackend::~XShmCaptureBackend()
+{
+    releaseSegment();
+    if (m_display) {
+        XCloseDisplay(m_display);
+    }
+}
+
+bool XShmCaptureBackend::init()
+{
+    m_display = XOpenDisplay(nullptr);
+    if (!m_display || !XShmQueryExtension(m_display)) {
+        return false;
+    }
+
+    // Frames are handed to Qt as Format_RGB32, which needs a 24-bit TrueColor root
+    const int screen = DefaultScreen(m_display);
+    return DefaultDepth(m_display, screen) == 24
+        && DefaultVisual(m_display, screen)->c_class == TrueColor;
+}
+
+void XShmCaptureBackend::releaseSegment()
+{
+    if (m_image) {
+        // The pixel data belongs to the segment, not to Xlib
+        m_image->data = nullptr;
+        XDestroyImage(m_image);
+        m_image = nullptr;
+    }
+    if (m_shm.shmaddr) {
+        XShmDetach(m_display, &m_shm);
+        XSync(m_display, False);
+        shmdt(m_shm.shmaddr);
+        m_shm = {};
+    }
+    m_segmentSize = 0;
+}
+
+bool XShmCaptureBackend::ensureImage(int width, int height)
+{
+    if (m_image && m_image->width == width && m_image->height == height) {
+        return true;
+    }
+
+    const int screen = DefaultScreen(m_display);
+    Visual *visual = DefaultVisual(m_display, screen);
+    const int depth = DefaultDepth(m_display, screen);
+
+    // A new XImage header is cheap; the segment is only replaced when it grows
+    if (m_image) {
+        m_image->data = nullptr;
+        XDestroyImage(m_image);
+        m_image = nullptr;
+    }
+
+    const size_t needed = size_t(width) * height * 4;
+    if (needed > m_segmentSize) {
+        releaseSegment();
+
+        m_shm.shmid = shmget(IPC_PRIVATE, needed, IPC_CREAT | 0600);
+        if (m_shm.shmid < 0) {
+            qWarning() << "shmget failed for" << width << "x" << height << "capture";
+            m_shm = {};
+            return false;
+        }
+        m_shm.shmaddr = static_cast<char *>(shmat(m_shm.shmid, nullptr, 0));
+        m_shm.readOnly = False;
+        if (m_shm.shmaddr == reinterpret_cast<char *>(-1) || !XShmAttach(m_display, &m_shm)) {
+            shmctl(m_shm.shmid, IPC_RMID, nullptr);
+            m_shm = {};
+            return false;
+        }
+        XSync(m_display, False);
+
+        // Marked for removal now so the segment cannot outlive the process
+        shmctl(m_shm.shmid, IPC_RMID, nullptr);
+        m_segmentSize = needed;
+    }
+
+    m_image = XShmCreateImage(m_display, visual, depth, ZPixmap,
+                              m_shm.shmaddr, &m_shm, width, height);
+    return m_image && m_image->bits_per_pixel == 32;
+}
+
+// Where the part of region that was actually read, in device pixels, goes
+// in logical pixels relative to region. Parts of region beyond the root
+// or the window are not read, and stay empty rather than stretched over.
+static QRect clippedTarget(const QRect &native, const QRect &region, qreal ratio)
+{
+    return QRectF(native.x() / ratio - region.x(), native.y() / ratio - region.y(),
+                  native.width() / ratio, native.height() / ratio).toRect();
+}
+
+QList<CapturedImage> XShmCaptureBackend::grab(const QRect &region)
+{
+    // The root window is in device pixels
+    QScreen *primary = QGuiApplication::primaryScreen();
+    const qreal ratio = primary ? primary->devicePixelRatio() : 1.0;
+
+    const int screen = DefaultScreen(m_display);
+    const QRect root(0, 0, DisplayWidth(m_display, screen), DisplayHeight(m_display, screen));
+    const QRect native = QRect(qFloor(region.x() * ratio), qFloor(region.y() * ratio),
+                               qCeil(region.width() * ratio), qCeil(region.height() * ratio)) & root;
+    if (native.isEmpty() || !ensureImage(native.width(), native.height())) {
+        return {};
+    }
+
+    if (!XShmGetImage(m_display, DefaultRootWindow(m_display), m_image,
+                      native.x(), native.y(), AllPlanes)) {
+        return {};
+    }
+
+    QImage image(reinterpret_cast<const uchar *>(m_image->data), m_image->width, m_image->height,
+                 m_image->bytes_per_line, QImage::Format_RGB32);
+    image.setDevicePixelRatio(ratio);
+    return {{image, clippedTarget(native, region, ratio)}};
+}
+
+static bool s_windowGrabFailed = false;
+
+static int recordWindowGrabError(Display *, XErrorEvent *)
+{
+    s_windowGrabFailed = true;
+    return 0;
+}
+
+QList<CapturedImage> XShmCaptureBackend::grabWindow(quint64 window, const QRect &geometry, const QRect &region)
+{
+    // Reading the window's own drawable leaves out whatever overlaps it.
+    // Under a compositing manager obscured parts are read too; without one
+    // the X server keeps no copy of them and they come back undefined.
+    QScreen *primary = QGuiApplication::primaryScreen();
+    const qreal ratio = primary ? primary->devicePixelRatio() : 1.0;
+    const int screen = DefaultScreen(m_display);
+
+    // The window may go away at any moment, which must not end the process
+    XSync(m_display, False);
+    s_windowGrabFailed = false;
+    XErrorHandler previous = XSetErrorHandler(recordWindowGrabError);
+
+    QList<CapturedImage> parts;
+    XWindowAttributes attributes;
+    if (XGetWindowAttributes(m_display, window, &attributes)
+        && attributes.map_state == IsViewable
+        && attributes.depth == DefaultDepth(m_display, screen)
+        && attributes.visual == DefaultVisual(m_display, screen)) {
+        const QRect native = QRect(qFloor(region.x() * ratio), qFloor(region.y() * ratio),
+                                   qCeil(region.width() * ratio), qCeil(region.height() * ratio))
+            & QRect(0, 0, attributes.width, attributes.height);
+        if (!native.isEmpty() && ensureImage(native.width(), native.height())
+            && XShmGetImage(m_display, window, m_image, native.x(), native.y(), AllPlanes)) {
+            QImage image(reinterpret_cast<const uchar *>(m_image->data), m_image->width, m_image->height,
+                         m_image->bytes_per_line, QImage::Format_RGB32);
+            image.setDevicePixelRatio(ratio);
+            parts.append({image, clippedTarget(native, region, ratio)});
+        }
+    }
+
+    XSync(m_display, False);
+    XSetErrorHandler(previous);
+    if (s_windowGrabFailed) {
+        parts.clear();
+    }
+
+    // An ARGB window or one that is not mapped is read from the desktop
+    return parts.isEmpty() ? CaptureBackend::grabWindow(window, geometry, region) : parts;
+}
+
+#endif // HAVE_XSHM
+
+std::unique_ptr<CaptureBackend> CaptureBackend::create()
+{
+    const QByteArray requested = qgetenv("PCREMOTE_CAPTURE_BACKEND");
+
+#ifdef HAVE_XSHM
+    if (requested != "qscreen" && QGuiApplication::platformName() == QLatin1String("xcb")) {
+        auto backend = std::make_unique<XShmCaptureBackend>();
+        if (backend->init()) {
+            return backend;
+        }
+        qDebug() << "MIT-SHM capture unavailable, using QScreen::grabWindow";
+    }
+#else
+    Q_UNUSED(requested)
+#endif
+
+    return std::make_unique<QScreenCaptureBackend>();
+}
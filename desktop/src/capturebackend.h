@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#pragma once
+
+#include <QImage>
+#include <QList>
+#include <QRect>
+#include <memory>
+
+// A piece of a captured region and where it belongs within that region
+struct CapturedImage
+{
+    QImage image;
+    QRect target; // Logical pixels relative to the captured region
+};
+
+// Reads pixels from the display. Images returned by grab() may point into
+// memory owned by the backend and are only valid until the next grab().
+class CaptureBackend
+{
+public:
+    virtual ~CaptureBackend() = default;
+
+    virtual const char *name() const = 0;
+
+    // Capture a region of the desktop given in global logical coordinates.
+    // Must be called on the GUI thread.
+    virtual QList<CapturedImage> grab(const QRect &region) = 0;
+
+    // Capture part of one top-level window. geometry is the window's place
+    // on the desktop and region is relative to it, both in logical pixels.
+    // By default this reads that area of the desktop, including anything
+    // that overlaps the window.
+    virtual QList<CapturedImage> grabWindow(quint64 window, const QRect &geometry, const QRect &region);
+
+    // Picks the fastest backend available on this platform. Setting
+    // PCREMOTE_CAPTURE_BACKEND=qscreen forces the portable fallback.
+    static std::unique_ptr<CaptureBackend> create();
+};
+
+// Portable fallback using QScreen::grabWindow, one grab per screen
+class QScreenCaptureBackend : public CaptureBackend
+{
+public:
+    const char *name() const override { return "qscreen"; }
+    QList<CapturedImage> grab(const QRect &region) override;
+};
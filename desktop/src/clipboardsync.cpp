@@ -0,0 +1,494 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#include "clipboardsync.h"
+#include <QBuffer>
+#include <QClipboard>
+#include <QGuiApplication>
+#include <QHashFunctions>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QMimeData>
+#include <QPointer>
+#include <QWebSocket>
+#include <QtEndian>
+#include <QDebug>
+#include <cstring>
+
+static const char ChunkMagic[4] = { 'P', 'C', 'R', 'C' };
+static const int ChunkHeaderSize = 12;
+static const int ChunkSize = 64 * 1024;
+// Chunk bytes allowed in a socket's write buffer at once; keeps frames and
+// acks from waiting behind a large transfer
+static const qint64 SendWindow = 2 * ChunkSize;
+static const int InlineTextLimit = 16 * 1024;
+static const qint64 MaxContentSize = 64 * 1024 * 1024;
+
+ClipboardSync::ClipboardSync(QObject *parent)
+    : QObject(parent)
+{
+    connect(QGuiApplication::clipboard(), &QClipboard::dataChanged,
+            this, &ClipboardSync::onClipboardChanged);
+}
+
+ClipboardSync::~ClipboardSync()
+{
+    m_encodePool.waitForDone();
+}
+
+bool ClipboardSync::isChunk(const QByteArray &message)
+{
+    return message.size() >= ChunkHeaderSize && memcmp(message.constData(), ChunkMagic, 4) == 0;
+}
+
+void ClipboardSync::handleRequest(const QJsonObject &request, QWebSocket *client)
+{
+    QString action = request["action"].toString();
+
+    if (action == "subscribe") {
+        if (!m_subscribers.contains(client)) {
+            m_subscribers.append(client);
+        }
+        if (m_current.hash.isEmpty()) {
+            onClipboardChanged();
+        }
+        // The reply describes what is on the clipboard now
+        QJsonObject response = describe(m_current);
+        response["id"] = request["id"];
+        client->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
+    } else if (action == "unsubscribe") {
+        m_subscribers.removeAll(client);
+    } else if (action == "fetch") {
+        fetch(request, client);
+    } else if (action == "set") {
+        setFromClient(request, client);
+    } else if (action == "upload") {
+        beginUpload(request, client);
+    }
+}
+
+void ClipboardSync::reattachClient(QWebSocket *from, QWebSocket *to, const QJsonObject &received)
+{
+    const int index = m_subscribers.indexOf(from);
+    if (index >= 0) {
+        m_subscribers[index] = to;
+    }
+    if (m_current.origin == from) {
+        m_current.origin = to;
+    }
+
+    // Chunks written to the old socket may never have arrived
+    bool sending = false;
+    for (Outgoing &outgoing : m_outgoing) {
+        if (outgoing.client == from) {
+            outgoing.client = to;
+            const QString key = QString::number(outgoing.transfer);
+            if (received.contains(key)) {
+                outgoing.offset = qBound<qsizetype>(0, qsizetype(received[key].toDouble()), outgoing.offset);
+            }
+            sending = true;
+        }
+    }
+    m_inFlight.remove(from);
+    if (sending) {
+        trackWrites(to);
+        pump(to);
+    }
+
+    for (Incoming &incoming : m_incoming) {
+        if (incoming.client == from) {
+            incoming.client = to;
+        }
+    }
+}
+
+QJsonObject ClipboardSync::uploadOffsets(QWebSocket *client) const
+{
+    QJsonObject uploads;
+    for (auto it = m_incoming.constBegin(); it != m_incoming.constEnd(); ++it) {
+        if (it->client == client) {
+            uploads[QString::number(it.key())] = qint64(it->received);
+        }
+    }
+    return uploads;
+}
+
+void ClipboardSync::clientDisconnected(QWebSocket *client)
+{
+    m_subscribers.removeAll(client);
+    m_inFlight.remove(client);
+    for (int i = m_outgoing.size() - 1; i >= 0; --i) {
+        if (m_outgoing[i].client == client) {
+            m_outgoing.removeAt(i);
+        }
+    }
+    for (auto it = m_incoming.begin(); it != m_incoming.end();) {
+        if (it->client == client) {
+            it = m_incoming.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (m_current.origin == client) {
+        m_current.origin = nullptr;
+    }
+}
+
+QByteArray ClipboardSync::contentHash(const Content &content)
+{
+    // Only needs to tell versions apart within this server, so a fast
+    // non-cryptographic hash of every representation is enough
+    size_t hash = qHash(content.text, 0);
+    hash = qHashMulti(hash, content.html);
+    if (!content.image.isNull()) {
+        hash = qHashMulti(hash, content.image.width(), content.image.height(), int(content.image.format()));
+        hash = qHashBits(content.image.constBits(), size_t(content.image.sizeInBytes()), hash);
+    }
+    return QByteArray::number(quint64(hash), 16);
+}
+
+QJsonObject ClipboardSync::describe(const Content &content)
+{
+    QJsonArray formats;
+    if (!content.text.isNull()) {
+        QJsonObject format;
+        format["mime"] = "text/plain";
+        format["size"] = content.text.toUtf8().size();
+        formats.append(format);
+    }
+    if (!content.html.isNull()) {
+        QJsonObject format;
+        format["mime"] = "text/html";
+        format["size"] = content.html.toUtf8().size();
+        formats.append(format);
+    }
+    if (!content.image.isNull()) {
+        QJsonObject format;
+        format["mime"] = "image/png";
+        format["width"] = content.image.width();
+        format["height"] = content.image.height();
+        formats.append(format);
+    }
+
+    QJsonObject message;
+    message["type"] = "clipboard";
+    message["action"] = "changed";
+    message["hash"] = QString::fromLatin1(content.hash);
+    message["formats"] = formats;
+    // Short text is what is pasted most; save the round trip for it
+    if (!content.text.isNull() && content.text.size() <= InlineTextLimit / 4) {
+        message["text"] = content.text;
+    }
+    return message;
+}
+
+void ClipboardSync::onClipboardChanged()
+{
+    if (m_applying) {
+        return; // Our own write; apply() already announced it
+    }
+
+    const QMimeData *mime = QGuiApplication::clipboard()->mimeData();
+    if (!mime) {
+        return;
+    }
+
+    Content content;
+    if (mime->hasText()) {
+        content.text = mime->text();
+    }
+    if (mime->hasHtml()) {
+        content.html = mime->html();
+    }
+    if (mime->hasImage()) {
+        content.image = qvariant_cast<QImage>(mime->imageData());
+    }
+    content.hash = contentHash(content);
+
+    // Applications often set the same content again, and a client's own
+    // content comes back through here after it is applied
+    if (content.hash == m_current.hash) {
+        return;
+    }
+
+    m_current = content;
+    notify(m_current);
+}
+
+void ClipboardSync::notify(const Content &content)
+{
+    const QByteArray message = QJsonDocument(describe(content)).toJson(QJsonDocument::Compact);
+    for (QWebSocket *subscriber : std::as_const(m_subscribers)) {
+        if (subscriber != content.origin && subscriber->isValid()) {
+            subscriber->sendTextMessage(QString::fromUtf8(message));
+        }
+    }
+}
+
+void ClipboardSync::apply(Content content)
+{
+    content.hash = contentHash(content);
+    if (content.hash == m_current.hash) {
+        return;
+    }
+
+    auto *mime = new QMimeData;
+    if (!content.text.isNull()) {
+        mime->setText(content.text);
+    }
+    if (!content.html.isNull()) {
+        mime->setHtml(content.html);
+    }
+    if (!content.image.isNull()) {
+        mime->setImageData(content.image);
+    }
+
+    m_applying = true;
+    QGuiApplication::clipboard()->setMimeData(mime);
+    m_applying = false;
+
+    m_current = content;
+    notify(m_current);
+    qDebug() << "Clipboard: Set from client";
+}
+
+void ClipboardSync::setFromClient(const QJsonObject &request, QWebSocket *client)
+{
+    // {"formats": {"text/plain": "...", "text/html": "..."}} for content
+    // small enough to send inline
+    const QJsonObject formats = request["formats"].toObject();
+
+    Content content;
+    content.origin = client;
+    if (formats.contains("text/plain")) {
+        content.text = formats["text/plain"].toString();
+    }
+    if (formats.contains("text/html")) {
+        content.html = formats["text/html"].toString();
+    }
+    apply(content);
+
+    QJsonObject response;
+    response["type"] = "clipboard";
+    response["action"] = "set";
+    response["id"] = request["id"];
+    response["status"] = "success";
+    response["hash"] = QString::fromLatin1(m_current.hash);
+    client->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
+}
+
+void ClipboardSync::beginUpload(const QJsonObject &request, QWebSocket *client)
+{
+    const QString mime = request["mime"].toString();
+    const qint64 size = request["size"].toInteger();
+    if ((mime != "text/plain" && mime != "text/html" && mime != "image/png")
+        || size <= 0 || size > MaxContentSize) {
+        sendError(client, request["id"], "Unsupported clipboard upload");
+        return;
+    }
+
+    Incoming incoming;
+    incoming.client = client;
+    incoming.mime = mime;
+    incoming.data.resize(size);
+    const quint32 transfer = m_nextTransfer++;
+    m_incoming.insert(transfer, incoming);
+
+    QJsonObject response;
+    response["type"] = "clipboard";
+    response["action"] = "upload";
+    response["id"] = request["id"];
+    response["status"] = "success";
+    response["transfer"] = qint64(transfer);
+    response["chunkSize"] = ChunkSize;
+    client->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
+}
+
+void ClipboardSync::handleBinary(const QByteArray &message, QWebSocket *client)
+{
+    const uchar *header = reinterpret_cast<const uchar *>(message.constData());
+    const quint32 transfer = qFromLittleEndian<quint32>(header + 4);
+    const quint32 offset = qFromLittleEndian<quint32>(header + 8);
+    const qsizetype length = message.size() - ChunkHeaderSize;
+
+    auto it = m_incoming.find(transfer);
+    if (it == m_incoming.end() || it->client != client
+        || qint64(offset) + length > it->data.size()) {
+        qWarning() << "Clipboard: Ignoring chunk for unknown transfer" << transfer;
+        return;
+    }
+
+    // Chunks have to arrive in order, so the data is complete exactly when
+    // received reaches the size and a resumed upload continues from received.
+    // A resent chunk that was already taken is dropped.
+    if (qsizetype(offset) != it->received) {
+        if (qint64(offset) + length > it->received) {
+            qWarning() << "Clipboard: Ignoring out of order chunk at" << offset
+                       << "for transfer" << transfer << "expecting" << it->received;
+        }
+        return;
+    }
+
+    memcpy(it->data.data() + offset, message.constData() + ChunkHeaderSize, length);
+    it->received += length;
+    if (it->received < it->data.size()) {
+        return;
+    }
+
+    const Incoming incoming = *it;
+    m_incoming.erase(it);
+
+    Content content;
+    content.origin = client;
+    if (incoming.mime == "text/plain") {
+        content.text = QString::fromUtf8(incoming.data);
+    } else if (incoming.mime == "text/html") {
+        content.html = QString::fromUtf8(incoming.data);
+    } else if (!content.image.loadFromData(incoming.data, "PNG")) {
+        qWarning() << "Clipboard: Uploaded image could not be decoded";
+        return;
+    } else {
+        content.png = incoming.data;
+    }
+    apply(content);
+}
+
+void ClipboardSync::fetch(const QJsonObject &request, QWebSocket *client)
+{
+    const QString mime = request["mime"].toString();
+    const QJsonValue id = request["id"];
+
+    // A stale hash means the client is asking for content that is gone
+    if (request.contains("hash") && request["hash"].toString().toLatin1() != m_current.hash) {
+        sendError(client, id, "Clipboard content changed");
+        return;
+    }
+
+    if (mime == "text/plain" && !m_current.text.isNull()) {
+        deliver(client, id, m_current.hash, mime, m_current.text.toUtf8());
+    } else if (mime == "text/html" && !m_current.html.isNull()) {
+        deliver(client, id, m_current.hash, mime, m_current.html.toUtf8());
+    } else if (mime == "image/png" && !m_current.image.isNull()) {
+        if (!m_current.png.isEmpty()) {
+            deliver(client, id, m_current.hash, mime, m_current.png);
+            return;
+        }
+
+        // PNG encoding of a screenshot takes long enough to stall input,
+        // so it runs on a worker and is cached for later fetches
+        const QImage image = m_current.image;
+        const QByteArray hash = m_current.hash;
+        QPointer<QWebSocket> target(client);
+        m_encodePool.start([this, image, hash, target, id, mime]() {
+            QByteArray png;
+            QBuffer buffer(&png);
+            buffer.open(QIODevice::WriteOnly);
+            image.save(&buffer, "PNG");
+
+            QMetaObject::invokeMethod(this, [this, png, hash, target, id, mime]() {
+                if (hash == m_current.hash) {
+                    m_current.png = png;
+                }
+                // Labeled with the hash of what was encoded, which may no
+                // longer be the current content
+                if (target) {
+                    deliver(target, id, hash, mime, png);
+                }
+            }, Qt::QueuedConnection);
+        });
+    } else {
+        sendError(client, id, "Format not available");
+    }
+}
+
+void ClipboardSync::deliver(QWebSocket *client, const QJsonValue &id, const QByteArray &hash,
+                            const QString &mime, const QByteArray &data)
+{
+    QJsonObject response;
+    response["type"] = "clipboard";
+    response["action"] = "data";
+    response["id"] = id;
+    response["status"] = "success";
+    response["hash"] = QString::fromLatin1(hash);
+    response["mime"] = mime;
+    response["size"] = data.size();
+
+    if (mime.startsWith("text/") && data.size() <= InlineTextLimit) {
+        response["data"] = QString::fromUtf8(data);
+        client->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
+        return;
+    }
+
+    // Announce the transfer, then stream it as chunks
+    Outgoing outgoing;
+    outgoing.client = client;
+    outgoing.transfer = m_nextTransfer++;
+    outgoing.data = data;
+    response["transfer"] = qint64(outgoing.transfer);
+    response["chunkSize"] = ChunkSize;
+    client->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
+
+    trackWrites(client);
+    m_outgoing.append(outgoing);
+    pump(client);
+}
+
+void ClipboardSync::trackWrites(QWebSocket *client)
+{
+    if (m_inFlight.contains(client)) {
+        return;
+    }
+    m_inFlight.insert(client, 0);
+    connect(client, &QWebSocket::bytesWritten, this, [this, client](qint64 bytes) {
+        auto it = m_inFlight.find(client);
+        if (it != m_inFlight.end()) {
+            *it = qMax<qint64>(0, *it - bytes);
+            pump(client);
+        }
+    });
+}
+
+void ClipboardSync::pump(QWebSocket *client)
+{
+    // A client that is about to resume gets the rest on its new connection
+    if (!client->isValid()) {
+        return;
+    }
+    qint64 &inFlight = m_inFlight[client];
+
+    // bytesWritten also counts other traffic, so the window errs towards
+    // sending slightly early rather than stalling
+    for (int i = 0; i < m_outgoing.size() && inFlight < SendWindow;) {
+        Outgoing &outgoing = m_outgoing[i];
+        if (outgoing.client != client) {
+            ++i;
+            continue;
+        }
+
+        const qsizetype length = qMin<qsizetype>(ChunkSize, outgoing.data.size() - outgoing.offset);
+        QByteArray chunk(ChunkHeaderSize + length, Qt::Uninitialized);
+        uchar *header = reinterpret_cast<uchar *>(chunk.data());
+        memcpy(header, ChunkMagic, 4);
+        qToLittleEndian<quint32>(outgoing.transfer, header + 4);
+        qToLittleEndian<quint32>(quint32(outgoing.offset), header + 8);
+        memcpy(header + ChunkHeaderSize, outgoing.data.constData() + outgoing.offset, length);
+
+        client->sendBinaryMessage(chunk);
+        inFlight += chunk.size();
+        outgoing.offset += length;
+
+        if (outgoing.offset >= outgoing.data.size()) {
+            m_outgoing.removeAt(i);
+        }
+    }
+}
+
+void ClipboardSync::sendError(QWebSocket *client, const QJsonValue &id, const QString &message)
+{
+    QJsonObject response;
+    response["type"] = "clipboard";
+    response["id"] = id;
+    response["status"] = "error";
+    response["message"] = message;
+    client->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
+}
@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QImage>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <QThreadPool>
+
+class QWebSocket;
+
+// Keeps the PC clipboard in sync with subscribed clients. Content is
+// identified by a hash so that unchanged content, and content a client has
+// just sent, are never sent again. Clients are told which MIME types are
+// available and fetch only those they support; small text is sent inline,
+// anything larger as binary chunks that are paced so they never queue
+// ahead of input or screen traffic on the same socket.
+//
+// Binary chunk layout (little endian):
+//   0  4  magic "PCRC"
+//   4  4  transfer id
+//   8  4  byte offset of the payload within the content
+//  12     payload
+class ClipboardSync : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ClipboardSync(QObject *parent = nullptr);
+    ~ClipboardSync();
+
+    void handleRequest(const QJsonObject &request, QWebSocket *client);
+    void handleBinary(const QByteArray &message, QWebSocket *client);
+    void clientDisconnected(QWebSocket *client);
+    // Moves subscriptions and transfers to a client's new connection.
+    // Outgoing transfers continue from the offsets in "received", transfer
+    // id to bytes the client has; uploadOffsets() gives the same for uploads.
+    void reattachClient(QWebSocket *from, QWebSocket *to, const QJsonObject &received);
+    QJsonObject uploadOffsets(QWebSocket *client) const;
+
+    static bool isChunk(const QByteArray &message);
+
+private slots:
+    void onClipboardChanged();
+
+private:
+    struct Content
+    {
+        QByteArray hash;
+        QString text;
+        QString html;
+        QImage image;
+        QByteArray png;   // Encoded on first fetch
+        QWebSocket *origin = nullptr;
+    };
+
+    struct Outgoing
+    {
+        QWebSocket *client = nullptr;
+        quint32 transfer = 0;
+        QByteArray data;
+        qsizetype offset = 0;
+    };
+
+    struct Incoming
+    {
+        QWebSocket *client = nullptr;
+        QString mime;
+        QByteArray data;
+        qsizetype received = 0;
+    };
+
+    void fetch(const QJsonObject &request, QWebSocket *client);
+    void setFromClient(const QJsonObject &request, QWebSocket *client);
+    void beginUpload(const QJsonObject &request, QWebSocket *client);
+    void apply(Content content);
+    void notify(const Content &content);
+    void deliver(QWebSocket *client, const QJsonValue &id, const QByteArray &hash,
+                 const QString &mime, const QByteArray &data);
+    void pump(QWebSocket *client);
+    void trackWrites(QWebSocket *client);
+    void sendError(QWebSocket *client, const QJsonValue &id, const QString &message);
+
+    static QByteArray contentHash(const Content &content);
+    static QJsonObject describe(const Content &content);
+
+    Content m_current;
+    bool m_applying = false;
+    QList<QWebSocket *> m_subscribers;
+
+    quint32 m_nextTransfer = 1;
+    QList<Outgoing> m_outgoing;
+    QHash<QWebSocket *, qint64> m_inFlight; // Chunk bytes not yet written out
+    QHash<quint32, Incoming> m_incoming;
+
+    QThreadPool m_encodePool;
+};
@@ -0,0 +1,339 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#include "commandscheduler.h"
+#include <QJsonArray>
+#include <QTimer>
+#include <QWebSocket>
+#include <algorithm>
+
+// A drain pass yields back to the event loop after this long so sockets
+// keep being read while a backlog is worked off
+static const qint64 PassBudgetNs = 2000000;
+// Messages a client may have waiting before new ones are refused
+static const size_t MaxQueuedPerClient = 256;
+
+CommandScheduler::CommandScheduler(Executor executor, QObject *parent)
+    : QObject(parent)
+    , m_executor(std::move(executor))
+    , m_timer(new QTimer(this))
+{
+    m_clock.start();
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &CommandScheduler::drain);
+
+    // Generous enough for interactive use, tight enough that one client
+    // cannot keep the event loop busy
+    setLimit("default", {50, 20});
+    setLimit("input", {500, 100});
+    setLimit("media", {20, 10});
+    setLimit("file", {20, 10});
+    setLimit("system", {1, 3});
+    setLimit("screen", {30, 10});
+    setLimit("audio", {10, 5});
+    setLimit("telemetry", {10, 5});
+    setLimit("process", {20, 10});
+    setLimit("clipboard", {50, 20});
+    setLimit("server", {10, 10});
+}
+
+CommandScheduler::~CommandScheduler() = default;
+
+void CommandScheduler::setLimit(const QString &type, const RateLimit &limit)
+{
+    auto it = m_typeIndex.constFind(type);
+    if (it != m_typeIndex.constEnd()) {
+        m_limits[it.value()] = limit;
+        return;
+    }
+    m_typeIndex.insert(type, m_types.size());
+    m_types.append(type);
+    m_limits.append(limit);
+}
+
+int CommandScheduler::typeIndex(const QString &type) const
+{
+    return m_typeIndex.value(type, 0);
+}
+
+void CommandScheduler::enqueue(QWebSocket *client, const QJsonObject &command)
+{
+    Pending pending;
+    pending.command = command;
+
+    // A batch is charged item by item to each item's own type
+    if (command["type"].toString() == "batch") {
+        const QJsonArray commands = command["commands"].toArray();
+        for (const QJsonValue &item : commands) {
+            const int index = typeIndex(item.toObject()["type"].toString());
+            auto cost = std::find_if(pending.costs.begin(), pending.costs.end(),
+                                     [index](const QPair<int, int> &c) { return c.first == index; });
+            if (cost != pending.costs.end()) {
+                ++cost->second;
+            } else {
+                pending.costs.append({index, 1});
+            }
+        }
+    } else {
+        pending.costs.append({typeIndex(command["type"].toString()), 1});
+    }
+
+    push(client, std::move(pending));
+}
+
+void CommandScheduler::enqueueBinary(QWebSocket *client, const QByteArray &message)
+{
+    // Payloads are not rate limited themselves, but queue behind the
+    // command that announced them
+    Pending pending;
+    pending.binary = message;
+    push(client, std::move(pending));
+}
+
+void CommandScheduler::push(QWebSocket *client, Pending &&pending)
+{
+    const qint64 now = m_clock.nsecsElapsed();
+    pending.receivedNs = now;
+
+    auto [it, inserted] = m_states.try_emplace(client);
+    ClientState &state = it->second;
+
+    if (coalesce(state, pending, client)) {
+        return;
+    }
+    if (!m_unlimited && state.queue.size() >= MaxQueuedPerClient) {
+        ++m_dropped;
+        emit discarded(client, pending.command, Overflow);
+        return;
+    }
+
+    state.queue.push_back(std::move(pending));
+    ++m_queued;
+    m_maxDepth = qMax(m_maxDepth, m_queued);
+
+    if (!state.scheduled && !state.paused && state.readyAtNs <= now) {
+        state.scheduled = true;
+        m_ready.push_back(client);
+        if (!m_timer->isActive() || m_timer->interval() != 0) {
+            m_timer->start(0);
+        }
+    }
+}
+
+bool CommandScheduler::coalesce(ClientState &state, const Pending &pending, QWebSocket *client)
+{
+    // Only the newest queued message is a candidate, merging past anything
+    // else would reorder the client's commands
+    if (m_unlimited || state.queue.empty() || pending.command.isEmpty()) {
+        return false;
+    }
+    Pending &tail = state.queue.back();
+    const QString type = pending.command["type"].toString();
+    const QString action = pending.command["action"].toString();
+    if (tail.command["type"].toString() != type || tail.command["action"].toString() != action) {
+        return false;
+    }
+
+    const QJsonObject superseded = tail.command;
+    if (type == "input" && action == "mouse_move") {
+        QJsonObject merged = pending.command;
+        merged["deltaX"] = superseded["deltaX"].toInt() + pending.command["deltaX"].toInt();
+        merged["deltaY"] = superseded["deltaY"].toInt() + pending.command["deltaY"].toInt();
+        tail.command = merged;
+    } else if (type == "media" && action == "volume") {
+        tail.command = pending.command;
+    } else {
+        return false;
+    }
+
+    ++m_coalesced;
+    emit discarded(client, superseded, Coalesced);
+    return true;
+}
+
+void CommandScheduler::removeClient(QWebSocket *client)
+{
+    auto it = m_states.find(client);
+    if (it == m_states.end()) {
+        return;
+    }
+    m_queued -= it->second.queue.size();
+    m_states.erase(it);
+    m_ready.erase(std::remove(m_ready.begin(), m_ready.end(), client), m_ready.end());
+}
+
+void CommandScheduler::pauseClient(QWebSocket *client)
+{
+    auto it = m_states.find(client);
+    if (it != m_states.end()) {
+        it->second.paused = true;
+    }
+}
+
+void CommandScheduler::reattachClient(QWebSocket *from, QWebSocket *to)
+{
+    auto it = m_states.find(from);
+    if (it == m_states.end()) {
+        return;
+    }
+    ClientState moved = std::move(it->second);
+    m_states.erase(it);
+    m_ready.erase(std::remove(m_ready.begin(), m_ready.end(), from), m_ready.end());
+
+    // The old connection's messages came first; its budget carries over
+    ClientState &state = m_states[to];
+    for (Pending &pending : state.queue) {
+        moved.queue.push_back(std::move(pending));
+    }
+    moved.paused = false;
+    moved.scheduled = state.scheduled;
+    state = std::move(moved);
+
+    if (!state.scheduled && !state.queue.empty()) {
+        state.scheduled = true;
+        m_ready.push_back(to);
+        m_timer->start(0);
+    }
+}
+
+qint64 CommandScheduler::reserve(ClientState &state, const Pending &pending, qint64 nowNs)
+{
+    if (m_unlimited) {
+        return 0;
+    }
+    if (int(state.buckets.size()) < m_limits.size()) {
+        TokenBucket full;
+        full.updatedNs = nowNs;
+        for (int i = int(state.buckets.size()); i < m_limits.size(); ++i) {
+            full.tokens = m_limits[i].burst;
+            state.buckets.push_back(full);
+        }
+    }
+
+    qint64 waitNs = 0;
+    for (const auto &[index, cost] : pending.costs) {
+        const RateLimit &limit = m_limits[index];
+        if (limit.rate <= 0) {
+            continue;
+        }
+        TokenBucket &bucket = state.buckets[index];
+        bucket.tokens = qMin(limit.burst, bucket.tokens + (nowNs - bucket.updatedNs) * limit.rate / 1e9);
+        bucket.updatedNs = nowNs;
+
+        // A batch larger than the burst runs once the bucket is full and
+        // leaves it in debt
+        const double needed = qMin(double(cost), limit.burst);
+        if (bucket.tokens < needed) {
+            waitNs = qMax(waitNs, qint64((needed - bucket.tokens) / limit.rate * 1e9) + 1);
+        }
+    }
+    if (waitNs > 0) {
+        return waitNs;
+    }
+
+    for (const auto &[index, cost] : pending.costs) {
+        if (m_limits[index].rate > 0) {
+            state.buckets[index].tokens -= cost;
+        }
+    }
+    return 0;
+}
+
+void CommandScheduler::drain()
+{
+    QElapsedTimer pass;
+    pass.start();
+
+    const qint64 wakeNs = m_clock.nsecsElapsed();
+    for (auto &[client, state] : m_states) {
+        if (!state.scheduled && !state.paused && !state.queue.empty() && state.readyAtNs <= wakeNs) {
+            state.scheduled = true;
+            m_ready.push_back(client);
+        }
+    }
+
+    while (!m_ready.empty() && pass.nsecsElapsed() < PassBudgetNs) {
+        QWebSocket *client = m_ready.front();
+        m_ready.pop_front();
+
+        auto it = m_states.find(client);
+        if (it == m_states.end()) {
+            continue;
+        }
+        ClientState &state = it->second;
+        state.scheduled = false;
+        if (state.queue.empty() || state.paused) {
+            continue;
+        }
+
+        const qint64 now = m_clock.nsecsElapsed();
+        Pending &head = state.queue.front();
+        const qint64 waitNs = reserve(state, head, now);
+        if (waitNs > 0) {
+            if (!head.throttled) {
+                head.throttled = true;
+                ++m_throttled;
+            }
+            state.readyAtNs = now + waitNs;
+            continue;
+        }
+
+        Pending pending = std::move(head);
+        state.queue.pop_front();
+        --m_queued;
+        if (!state.queue.empty()) {
+            state.scheduled = true;
+            m_ready.push_back(client);
+        }
+
+        // The executor may disconnect the client, so state is not touched
+        // after this point
+        m_executor(client, pending.command, pending.binary, now - pending.receivedNs);
+    }
+
+    scheduleNext();
+}
+
+void CommandScheduler::scheduleNext()
+{
+    if (!m_ready.empty()) {
+        m_timer->start(0);
+        return;
+    }
+
+    qint64 nextNs = -1;
+    for (const auto &[client, state] : m_states) {
+        if (!state.queue.empty() && !state.scheduled && !state.paused) {
+            nextNs = nextNs < 0 ? state.readyAtNs : qMin(nextNs, state.readyAtNs);
+        }
+    }
+    if (nextNs < 0) {
+        m_timer->stop();
+        return;
+    }
+
+    const qint64 delayNs = qMax<qint64>(0, nextNs - m_clock.nsecsElapsed());
+    m_timer->start(int((delayNs + 999999) / 1000000));
+}
+
+QJsonObject CommandScheduler::stats() const
+{
+    QJsonObject limits;
+    for (int i = 0; i < m_types.size(); ++i) {
+        QJsonObject limit;
+        limit["rate"] = m_limits[i].rate;
+        limit["burst"] = m_limits[i].burst;
+        limits[m_types[i]] = limit;
+    }
+
+    QJsonObject stats;
+    stats["queued"] = qint64(m_queued);
+    stats["maxQueued"] = qint64(m_maxDepth);
+    stats["throttled"] = qint64(m_throttled);
+    stats["coalesced"] = qint64(m_coalesced);
+    stats["dropped"] = qint64(m_dropped);
+    stats["limits"] = limits;
+    stats["unlimited"] = m_unlimited;
+    return stats;
+}
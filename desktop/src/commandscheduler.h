@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QStringList>
+#include <QVarLengthArray>
+#include <QVector>
+#include <deque>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+class QTimer;
+class QWebSocket;
+
+// Sustained commands per second and how many may arrive at once. A rate of
+// zero or less leaves the type unlimited.
+struct RateLimit
+{
+    double rate = 0;
+    double burst = 0;
+};
+
+// Queues inbound messages per client and runs them in round-robin order,
+// one message per client per turn, so a client flooding the socket cannot
+// starve the others. Each client has a token bucket per command type;
+// a client whose next message has no tokens left waits without holding up
+// anyone else. Messages of one client always run in the order received.
+//
+// While a client has a backlog, a new mouse_move merges its deltas into a
+// queued one and a new media volume replaces a queued one, so a throttled
+// client catches up with the latest state instead of replaying history.
+class CommandScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Text messages carry a command, binary messages a payload
+    using Executor = std::function<void(QWebSocket *client, const QJsonObject &command,
+                                        const QByteArray &binary, qint64 queuedNs)>;
+
+    enum Discard {
+        Coalesced, // Superseded by a newer command of the same kind
+        Overflow,  // The client already had too many messages queued
+    };
+    Q_ENUM(Discard)
+
+    explicit CommandScheduler(Executor executor, QObject *parent = nullptr);
+    ~CommandScheduler();
+
+    // "default" applies to every type without a limit of its own
+    void setLimit(const QString &type, const RateLimit &limit);
+    // Runs every message in turn with no rate limits, coalescing or queue
+    // cap, so a benchmark measures dispatch rather than the limiter
+    void setUnlimited(bool unlimited) { m_unlimited = unlimited; }
+
+    void enqueue(QWebSocket *client, const QJsonObject &command);
+    void enqueueBinary(QWebSocket *client, const QByteArray &message);
+    void removeClient(QWebSocket *client);
+    // Holds a client's queued messages until it is removed or moved to a
+    // new connection, which gets them ahead of its own
+    void pauseClient(QWebSocket *client);
+    void reattachClient(QWebSocket *from, QWebSocket *to);
+
+    QJsonObject stats() const;
+
+signals:
+    void discarded(QWebSocket *client, const QJsonObject &command, CommandScheduler::Discard reason);
+
+private:
+    struct TokenBucket
+    {
+        double tokens = 0;
+        qint64 updatedNs = 0;
+    };
+
+    struct Pending
+    {
+        QJsonObject command;
+        QByteArray binary;
+        qint64 receivedNs = 0;
+        // Tokens taken from each type's bucket, a batch may charge several
+        QVarLengthArray<QPair<int, int>, 1> costs;
+        bool throttled = false;
+    };
+
+    struct ClientState
+    {
+        std::deque<Pending> queue;
+        std::vector<TokenBucket> buckets;
+        qint64 readyAtNs = 0;
+        bool scheduled = false;
+        bool paused = false;
+    };
+
+    void push(QWebSocket *client, Pending &&pending);
+    bool coalesce(ClientState &state, const Pending &pending, QWebSocket *client);
+    int typeIndex(const QString &type) const;
+    // Takes the tokens for a message, or returns how long until they exist
+    qint64 reserve(ClientState &state, const Pending &pending, qint64 nowNs);
+    void drain();
+    void scheduleNext();
+
+    Executor m_executor;
+    QTimer *m_timer;
+    QElapsedTimer m_clock;
+    QStringList m_types;
+    QVector<RateLimit> m_limits;
+    QHash<QString, int> m_typeIndex;
+    bool m_unlimited = false;
+
+    std::unordered_map<QWebSocket *, ClientState> m_states;
+    std::deque<QWebSocket *> m_ready;
+
+    quint64 m_queued = 0;
+    quint64 m_maxDepth = 0;
+    quint64 m_throttled = 0;
+    quint64 m_coalesced = 0;
+    quint64 m_dropped = 0;
+};
@@ -0,0 +1,204 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#include "cursortracker.h"
+#include <QBuffer>
+#include <QCursor>
+#include <QGuiApplication>
+#include <QScreen>
+#include <QSocketNotifier>
+#include <QTimer>
+#include <QDebug>
+
+#ifdef HAVE_XFIXES
+#include <X11/Xlib.h>
+#include <X11/extensions/Xfixes.h>
+#endif
+
+// Pointer updates are tiny, so they can go out far more often than frames
+static const int PollIntervalMs = 8;
+
+// Once the pointer has been still for a while, polling slows down until it
+// moves again; the first movement is reported at most this late
+static const int IdlePollIntervalMs = 50;
+static const int IdlePollsBeforeBackoff = 32;
+
+// Applications rarely use more than a handful of cursors
+static const int MaxCachedShapes = 64;
+
+struct CursorTracker::X11State
+{
+#ifdef HAVE_XFIXES
+    Display *display = nullptr;
+    int fixesEventBase = 0;
+#endif
+};
+
+CursorTracker::CursorTracker(QObject *parent)
+    : QObject(parent)
+    , m_x11(std::make_unique<X11State>())
+    , m_pollTimer(new QTimer(this))
+{
+    m_pollTimer->setInterval(PollIntervalMs);
+    connect(m_pollTimer, &QTimer::timeout, this, &CursorTracker::poll);
+
+    if (!initX11()) {
+        qDebug() << "Cursor shapes unavailable, clients will draw a default pointer";
+    }
+}
+
+CursorTracker::~CursorTracker()
+{
+#ifdef HAVE_XFIXES
+    if (m_x11->display) {
+        XCloseDisplay(m_x11->display);
+    }
+#endif
+}
+
+void CursorTracker::start()
+{
+    m_lastPosition = QPoint(-1, -1);
+    m_unchangedPolls = 0;
+    m_pollTimer->start(PollIntervalMs);
+    if (m_notifier) {
+        m_notifier->setEnabled(true);
+        fetchShape();
+    }
+}
+
+void CursorTracker::stop()
+{
+    m_pollTimer->stop();
+    if (m_notifier) {
+        m_notifier->setEnabled(false);
+    }
+}
+
+const CursorTracker::Shape *CursorTracker::shape(quint64 id) const
+{
+    auto it = m_shapes.constFind(id);
+    return it == m_shapes.constEnd() ? nullptr : &it.value();
+}
+
+void CursorTracker::poll()
+{
+    const QPoint position = QCursor::pos();
+    if (position != m_lastPosition) {
+        m_lastPosition = position;
+        if (m_unchangedPolls >= IdlePollsBeforeBackoff) {
+            m_pollTimer->setInterval(PollIntervalMs);
+        }
+        m_unchangedPolls = 0;
+        emit moved(position);
+    } else if (++m_unchangedPolls == IdlePollsBeforeBackoff) {
+        m_pollTimer->setInterval(IdlePollIntervalMs);
+    }
+}
+
+bool CursorTracker::initX11()
+{
+#ifdef HAVE_XFIXES
+    if (QGuiApplication::platformName() != QLatin1String("xcb")) {
+        return false;
+    }
+
+    Display *display = XOpenDisplay(nullptr);
+    int errorBase = 0;
+    if (!display || !XFixesQueryExtension(display, &m_x11->fixesEventBase, &errorBase)) {
+        if (display)
+            XCloseDisplay(display);
+        return false;
+    }
+
+    int major = 0;
+    int minor = 0;
+    XFixesQueryVersion(display, &major, &minor);
+    if (major < 2) {
+        // Cursor images need XFixes 2
+        XCloseDisplay(display);
+        return false;
+    }
+
+    m_x11->display = display;
+    XFixesSelectCursorInput(display, DefaultRootWindow(display), XFixesDisplayCursorNotifyMask);
+    XFlush(display);
+
+    m_notifier = new QSocketNotifier(ConnectionNumber(display), QSocketNotifier::Read, this);
+    m_notifier->setEnabled(false);
+    connect(m_notifier, &QSocketNotifier::activated, this, &CursorTracker::processEvents);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void CursorTracker::processEvents()
+{
+#ifdef HAVE_XFIXES
+    bool changed = false;
+    while (XPending(m_x11->display)) {
+        XEvent event;
+        XNextEvent(m_x11->display, &event);
+        if (event.type == m_x11->fixesEventBase + XFixesCursorNotify) {
+            changed = true;
+        }
+    }
+    if (changed) {
+        fetchShape();
+    }
+
+    // Events read during the round trip above never wake the socket notifier
+    if (XEventsQueued(m_x11->display, QueuedAlready) > 0) {
+        QMetaObject::invokeMethod(this, &CursorTracker::processEvents, Qt::QueuedConnection);
+    }
+#endif
+}
+
+void CursorTracker::fetchShape()
+{
+#ifdef HAVE_XFIXES
+    XFixesCursorImage *cursor = XFixesGetCursorImage(m_x11->display);
+    if (!cursor) {
+        return;
+    }
+
+    // Xlib hands out 32-bit premultiplied ARGB pixels widened to unsigned long
+    QImage image(cursor->width, cursor->height, QImage::Format_ARGB32_Premultiplied);
+    const unsigned long *pixels = cursor->pixels;
+    for (int y = 0; y < image.height(); ++y) {
+        auto *line = reinterpret_cast<quint32 *>(image.scanLine(y));
+        for (int x = 0; x < image.width(); ++x) {
+            line[x] = quint32(*pixels++);
+        }
+    }
+    const QPoint hotSpot(cursor->xhot, cursor->yhot);
+    XFree(cursor);
+
+    QScreen *primary = QGuiApplication::primaryScreen();
+    image.setDevicePixelRatio(primary ? primary->devicePixelRatio() : 1.0);
+
+    const quint64 id = qHashBits(image.constBits(), size_t(image.sizeInBytes()),
+                                 qHash(hotSpot.x()) ^ qHash(hotSpot.y() << 16));
+    if (id == m_shapeId) {
+        return;
+    }
+
+    if (!m_shapes.contains(id)) {
+        if (m_shapes.size() >= MaxCachedShapes) {
+            m_shapes.clear();
+        }
+
+        Shape shape;
+        shape.image = image;
+        shape.hotSpot = hotSpot;
+        QBuffer buffer(&shape.png);
+        buffer.open(QIODevice::WriteOnly);
+        image.save(&buffer, "PNG");
+        m_shapes.insert(id, shape);
+    }
+
+    m_shapeId = id;
+    emit shapeChanged(id);
+#endif
+}
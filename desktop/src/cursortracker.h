@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QImage>
+#include <QPoint>
+#include <memory>
+
+class QTimer;
+class QSocketNotifier;
+
+// Follows the pointer so it can be drawn by the client instead of being
+// part of the streamed frames. Positions are polled at a high rate while
+// the pointer moves and slowly while it is still; shapes are read when the
+// display reports a change and are identified by a hash of their pixels.
+class CursorTracker : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Shape
+    {
+        QImage image;
+        QPoint hotSpot;
+        QByteArray png;
+    };
+
+    explicit CursorTracker(QObject *parent = nullptr);
+    ~CursorTracker();
+
+    void start();
+    void stop();
+
+    // Zero when the platform cannot report cursor shapes
+    quint64 shapeId() const { return m_shapeId; }
+    const Shape *shape(quint64 id) const;
+
+signals:
+    void moved(const QPoint &position);
+    void shapeChanged(quint64 id);
+
+private slots:
+    void poll();
+    void processEvents();
+
+private:
+    struct X11State;
+
+    bool initX11();
+    void fetchShape();
+
+    std::unique_ptr<X11State> m_x11;
+    QTimer *m_pollTimer;
+    QSocketNotifier *m_notifier = nullptr;
+    QPoint m_lastPosition;
+    int m_unchangedPolls = 0;
+    quint64 m_shapeId = 0;
+    QHash<quint64, Shape> m_shapes;
+};
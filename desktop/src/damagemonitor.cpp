@@ -0,0 +1,143 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#include "damagemonitor.h"
+#include <QGuiApplication>
+#include <QScreen>
+#include <QSocketNotifier>
+#include <QtMath>
+#include <QDebug>
+
+#ifdef HAVE_XDAMAGE
+#include <X11/Xlib.h>
+#include <X11/extensions/Xdamage.h>
+#include <X11/extensions/Xfixes.h>
+#endif
+
+struct DamageMonitor::X11State
+{
+#ifdef HAVE_XDAMAGE
+    // A private connection, so it works the same under Xvfb and does not
+    // interfere with Qt's own xcb connection
+    Display *display = nullptr;
+    Damage damage = 0;
+    XserverRegion parts = 0;
+    int damageEventBase = 0;
+#endif
+};
+
+DamageMonitor::DamageMonitor(QObject *parent)
+    : QObject(parent)
+    , m_x11(std::make_unique<X11State>())
+{
+    if (!initX11()) {
+        qDebug() << "Damage notifications unavailable, falling back to polling";
+    }
+}
+
+DamageMonitor::~DamageMonitor()
+{
+#ifdef HAVE_XDAMAGE
+    if (m_x11->display) {
+        if (m_x11->parts)
+            XFixesDestroyRegion(m_x11->display, m_x11->parts);
+        if (m_x11->damage)
+            XDamageDestroy(m_x11->display, m_x11->damage);
+        XCloseDisplay(m_x11->display);
+    }
+#endif
+}
+
+bool DamageMonitor::isEventDriven() const
+{
+    return m_notifier != nullptr;
+}
+
+bool DamageMonitor::initX11()
+{
+#ifdef HAVE_XDAMAGE
+    // Under Wayland an X connection would only see XWayland clients
+    if (QGuiApplication::platformName() != QLatin1String("xcb")) {
+        return false;
+    }
+
+    Display *display = XOpenDisplay(nullptr);
+    if (!display) {
+        return false;
+    }
+
+    int damageErrorBase = 0;
+    int fixesEventBase = 0;
+    int fixesErrorBase = 0;
+    if (!XDamageQueryExtension(display, &m_x11->damageEventBase, &damageErrorBase)
+        || !XFixesQueryExtension(display, &fixesEventBase, &fixesErrorBase)) {
+        XCloseDisplay(display);
+        return false;
+    }
+
+    int major = 0;
+    int minor = 0;
+    XFixesQueryVersion(display, &major, &minor);
+    XDamageQueryVersion(display, &major, &minor);
+
+    // NonEmpty reports once per batch of changes; subtracting the damage in
+    // processEvents() re-arms it, which coalesces bursts at the source
+    m_x11->display = display;
+    m_x11->damage = XDamageCreate(display, DefaultRootWindow(display), XDamageReportNonEmpty);
+    m_x11->parts = XFixesCreateRegion(display, nullptr, 0);
+    XFlush(display);
+
+    m_notifier = new QSocketNotifier(ConnectionNumber(display), QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &DamageMonitor::processEvents);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void DamageMonitor::processEvents()
+{
+#ifdef HAVE_XDAMAGE
+    Display *display = m_x11->display;
+    bool sawDamage = false;
+
+    while (XPending(display)) {
+        XEvent event;
+        XNextEvent(display, &event);
+        if (event.type == m_x11->damageEventBase + XDamageNotify) {
+            sawDamage = true;
+        }
+    }
+
+    if (!sawDamage) {
+        return;
+    }
+
+    XDamageSubtract(display, m_x11->damage, 0, m_x11->parts);
+
+    int count = 0;
+    XRectangle bounds;
+    XRectangle *rects = XFixesFetchRegionAndBounds(display, m_x11->parts, &count, &bounds);
+    if (rects) {
+        XFree(rects);
+    }
+    XFlush(display);
+
+    // The round trip above may have queued events the socket notifier will
+    // never see, so make sure they are picked up
+    if (XEventsQueued(display, QueuedAlready) > 0) {
+        QMetaObject::invokeMethod(this, &DamageMonitor::processEvents, Qt::QueuedConnection);
+    }
+
+    if (count == 0) {
+        return;
+    }
+
+    // X reports device pixels; screens are laid out in logical pixels
+    QScreen *primary = QGuiApplication::primaryScreen();
+    const qreal ratio = primary ? primary->devicePixelRatio() : 1.0;
+    const QRect rect(qFloor(bounds.x / ratio), qFloor(bounds.y / ratio),
+                     qCeil(bounds.width / ratio) + 1, qCeil(bounds.height / ratio) + 1);
+    emit damaged(rect);
+#endif
+}
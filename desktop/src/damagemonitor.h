@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#pragma once
+
+#include <QObject>
+#include <QRect>
+#include <memory>
+
+class QSocketNotifier;
+
+// Reports which parts of the desktop changed. On X11 with the DAMAGE
+// extension this is driven by server notifications; elsewhere
+// isEventDriven() is false and callers have to poll.
+class DamageMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DamageMonitor(QObject *parent = nullptr);
+    ~DamageMonitor();
+
+    bool isEventDriven() const;
+
+signals:
+    // Bounding box of the damage in global logical coordinates
+    void damaged(const QRect &rect);
+
+private slots:
+    void processEvents();
+
+private:
+    struct X11State;
+
+    bool initX11();
+
+    std::unique_ptr<X11State> m_x11;
+    QSocketNotifier *m_notifier = nullptr;
+};
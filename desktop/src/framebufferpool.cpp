@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#include "framebufferpool.h"
+#include <QMutexLocker>
+#include <utility>
+
+FrameBufferRef::FrameBufferRef(FrameBuffer *buffer)
+    : m_buffer(buffer)
+{
+    if (m_buffer) {
+        m_buffer->m_refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+FrameBufferRef::FrameBufferRef(const FrameBufferRef &other)
+    : FrameBufferRef(other.m_buffer)
+{
+}
+
+FrameBufferRef::FrameBufferRef(FrameBufferRef &&other) noexcept
+    : m_buffer(std::exchange(other.m_buffer, nullptr))
+{
+}
+
+FrameBufferRef &FrameBufferRef::operator=(FrameBufferRef other) noexcept
+{
+    std::swap(m_buffer, other.m_buffer);
+    return *this;
+}
+
+FrameBufferRef::~FrameBufferRef()
+{
+    if (m_buffer && m_buffer->m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        m_buffer->m_pool->release(m_buffer);
+    }
+}
+
+FrameBufferPool::FrameBufferPool(int maxBuffers)
+    : m_maxBuffers(maxBuffers)
+{
+    m_buffers.reserve(maxBuffers);
+    m_free.reserve(maxBuffers);
+}
+
+FrameBufferPool::~FrameBufferPool() = default;
+
+FrameBufferRef FrameBufferPool::acquire()
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (!m_free.isEmpty()) {
+        return FrameBufferRef(m_free.takeLast());
+    }
+
+    if (int(m_buffers.size()) >= m_maxBuffers) {
+        return FrameBufferRef();
+    }
+
+    auto buffer = std::make_unique<FrameBuffer>();
+    buffer->m_pool = this;
+    m_buffers.push_back(std::move(buffer));
+    m_allocations.fetch_add(1, std::memory_order_relaxed);
+    return FrameBufferRef(m_buffers.back().get());
+}
+
+void FrameBufferPool::ensureImage(FrameBuffer &buffer, const QSize &size, QImage::Format format)
+{
+    if (buffer.image.size() == size && buffer.image.format() == format) {
+        return;
+    }
+    buffer.image = QImage(size, format);
+    m_allocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FrameBufferPool::ensureCapacity(QByteArray &array, qsizetype size)
+{
+    if (array.capacity() >= size) {
+        return;
+    }
+    // Leave headroom so small size fluctuations between frames do not regrow
+    array.reserve(size + size / 4);
+    m_allocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+int FrameBufferPool::inFlight() const
+{
+    QMutexLocker locker(&m_mutex);
+    return int(m_buffers.size() - m_free.size());
+}
+
+void FrameBufferPool::release(FrameBuffer *buffer)
+{
+    QMutexLocker locker(&m_mutex);
+    m_free.append(buffer);
+}
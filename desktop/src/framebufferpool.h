@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#pragma once
+
+#include <QByteArray>
+#include <QImage>
+#include <QMutex>
+#include <QVector>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class FrameBufferPool;
+
+// Working storage for one frame on its way from capture to the socket.
+// Buffers keep their capacity between frames, so once the pool has warmed
+// up a frame of the same size needs no new heap memory.
+struct FrameBuffer
+{
+    QImage image;       // Scaled frame ready for encoding
+    QByteArray encoded; // Compressed image
+    QVector<QByteArray> stripes; // Compressed stripes when a frame is split
+    QByteArray message; // Serialized message carrying the frame, sent as is
+    QVector<QByteArray> rectMessages; // One per area when only parts are sent
+
+private:
+    friend class FrameBufferPool;
+    friend class FrameBufferRef;
+
+    std::atomic<int> m_refs{0};
+    FrameBufferPool *m_pool = nullptr;
+};
+
+// Intrusively reference counted handle; the buffer goes back to its pool
+// when the last handle is released.
+class FrameBufferRef
+{
+public:
+    FrameBufferRef() = default;
+    FrameBufferRef(const FrameBufferRef &other);
+    FrameBufferRef(FrameBufferRef &&other) noexcept;
+    FrameBufferRef &operator=(FrameBufferRef other) noexcept;
+    ~FrameBufferRef();
+
+    FrameBuffer *get() const { return m_buffer; }
+    FrameBuffer *operator->() const { return m_buffer; }
+    FrameBuffer &operator*() const { return *m_buffer; }
+    explicit operator bool() const { return m_buffer != nullptr; }
+
+private:
+    friend class FrameBufferPool;
+    explicit FrameBufferRef(FrameBuffer *buffer);
+
+    FrameBuffer *m_buffer = nullptr;
+};
+
+// Recycles frame buffers across frames. The pool must outlive every
+// FrameBufferRef it hands out.
+class FrameBufferPool
+{
+public:
+    explicit FrameBufferPool(int maxBuffers = 4);
+    ~FrameBufferPool();
+
+    FrameBufferPool(const FrameBufferPool &) = delete;
+    FrameBufferPool &operator=(const FrameBufferPool &) = delete;
+
+    // Returns an idle buffer, or an empty ref when all buffers are in flight
+    FrameBufferRef acquire();
+
+    // Size the buffer's storage, counting any growth as an allocation
+    void ensureImage(FrameBuffer &buffer, const QSize &size, QImage::Format format);
+    void ensureCapacity(QByteArray &array, qsizetype size);
+    // For growth that happens inside Qt, e.g. a QBuffer writing past capacity
+    void noteAllocation() { m_allocations.fetch_add(1, std::memory_order_relaxed); }
+
+    quint64 allocations() const { return m_allocations.load(std::memory_order_relaxed); }
+    int inFlight() const;
+
+private:
+    friend class FrameBufferRef;
+    void release(FrameBuffer *buffer);
+
+    const int m_maxBuffers;
+    mutable QMutex m_mutex;
+    std::vector<std::unique_ptr<FrameBuffer>> m_buffers;
+    QVector<FrameBuffer *> m_free;
+    std::atomic<quint64> m_allocations{0};
+};
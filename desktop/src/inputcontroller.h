@@ -15,7 +15,7 @@ public:
     
     void handleAction(const QString &action, const QJsonObject &data);
 
-private:
+    // GUI thread only
     void moveMouse(int deltaX, int deltaY);
     void mouseClick(const QString &button);
     void sendKey(const QString &key);
@@ -0,0 +1,459 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#include "localframeserver.h"
+#include "capturebackend.h"
+#include "damagemonitor.h"
+#include <QGuiApplication>
+#include <QJsonDocument>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QPainter>
+#include <QScreen>
+#include <QTimer>
+#include <QtMath>
+#include <QDebug>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+static const size_t PageSize = 4096;
+// Frame notifications are skipped for a consumer this far behind; the
+// frames themselves are in the ring and it only misses the newest ones
+static const qint64 MaxPendingBytes = 64 * 1024;
+static const qint64 MaxLineLength = 64 * 1024;
+
+#ifdef Q_OS_LINUX
+static qint64 clockNs(clockid_t clock)
+{
+    timespec ts;
+    clock_gettime(clock, &ts);
+    return qint64(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+#endif
+
+LocalFrameServer::LocalFrameServer(QObject *parent)
+    : QObject(parent)
+    , m_captureTimer(new QTimer(this))
+    , m_damageMonitor(new DamageMonitor(this))
+{
+    connect(m_captureTimer, &QTimer::timeout, this, &LocalFrameServer::captureFrame);
+    connect(m_damageMonitor, &DamageMonitor::damaged, this, &LocalFrameServer::onDamaged);
+    m_captureTimer->setSingleShot(m_damageMonitor->isEventDriven());
+}
+
+LocalFrameServer::~LocalFrameServer()
+{
+    releaseRing();
+}
+
+bool LocalFrameServer::listen(const QString &path)
+{
+#ifdef Q_OS_LINUX
+    QLocalServer::removeServer(path);
+    m_server = new QLocalServer(this);
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+    if (!m_server->listen(path)) {
+        qWarning() << "Failed to listen on" << path << ":" << m_server->errorString();
+        return false;
+    }
+    connect(m_server, &QLocalServer::newConnection, this, &LocalFrameServer::onNewConnection);
+    qDebug() << "Local frame transport listening on" << path;
+    return true;
+#else
+    Q_UNUSED(path);
+    qWarning() << "The local frame transport is only available on Linux";
+    return false;
+#endif
+}
+
+void LocalFrameServer::onNewConnection()
+{
+    while (QLocalSocket *socket = m_server->nextPendingConnection()) {
+        connect(socket, &QLocalSocket::readyRead, this, &LocalFrameServer::onReadyRead);
+        connect(socket, &QLocalSocket::disconnected, this, &LocalFrameServer::onDisconnected);
+        Consumer consumer;
+        consumer.socket = socket;
+        m_consumers.append(consumer);
+    }
+}
+
+void LocalFrameServer::onReadyRead()
+{
+    QLocalSocket *socket = qobject_cast<QLocalSocket *>(sender());
+    auto consumer = std::find_if(m_consumers.begin(), m_consumers.end(),
+                                 [socket](const Consumer &c) { return c.socket == socket; });
+    if (consumer == m_consumers.end()) {
+        return;
+    }
+
+    while (socket->canReadLine()) {
+        const QJsonDocument doc = QJsonDocument::fromJson(socket->readLine());
+        if (doc.isObject()) {
+            handleMessage(*consumer, doc.object());
+        } else {
+            qWarning() << "Received invalid JSON on the local transport";
+        }
+    }
+    if (socket->bytesAvailable() > MaxLineLength) {
+        qWarning() << "Local consumer sent an overlong message";
+        socket->disconnectFromServer();
+    }
+}
+
+void LocalFrameServer::onDisconnected()
+{
+    QLocalSocket *socket = qobject_cast<QLocalSocket *>(sender());
+    m_consumers.erase(std::remove_if(m_consumers.begin(), m_consumers.end(),
+                                     [socket](const Consumer &c) { return c.socket == socket; }),
+                      m_consumers.end());
+    socket->deleteLater();
+    updateCapture();
+}
+
+void LocalFrameServer::handleMessage(Consumer &consumer, const QJsonObject &message)
+{
+    const QString action = message["action"].toString();
+    if (action == "start") {
+        start(consumer, message);
+    } else if (action == "stop") {
+        stop(consumer);
+    } else if (action == "stats") {
+        QJsonObject response;
+        response["type"] = "stats";
+        response["data"] = stats();
+        send(consumer.socket, response);
+    }
+}
+
+void LocalFrameServer::start(Consumer &consumer, const QJsonObject &message)
+{
+    // All consumers share one stream; the latest start picks screen and rate
+    m_screen = message["screen"].toString();
+    m_minFrameInterval = 1000 / qBound(1, message["maxFps"].toInt(30), 120);
+
+    consumer.streaming = true;
+    consumer.announced = false;
+    m_dirty = true;
+    m_sinceCapture.invalidate();
+    updateCapture();
+}
+
+void LocalFrameServer::stop(Consumer &consumer)
+{
+    consumer.streaming = false;
+    updateCapture();
+}
+
+void LocalFrameServer::updateCapture()
+{
+    const bool streaming = std::any_of(m_consumers.cbegin(), m_consumers.cend(),
+                                       [](const Consumer &c) { return c.streaming; });
+    if (!streaming) {
+        m_captureTimer->stop();
+        return;
+    }
+
+    if (!m_capture) {
+        m_capture = CaptureBackend::create();
+    }
+    // With damage events a capture is armed when something changes;
+    // otherwise poll at the frame interval
+    m_captureTimer->start(m_damageMonitor->isEventDriven() ? 0 : m_minFrameInterval);
+}
+
+void LocalFrameServer::onDamaged(const QRect &rect)
+{
+    if (!rect.intersects(captureRegion())) {
+        return;
+    }
+    m_dirty = true;
+    if (m_damageMonitor->isEventDriven() && m_capture && !m_captureTimer->isActive()
+        && std::any_of(m_consumers.cbegin(), m_consumers.cend(),
+                       [](const Consumer &c) { return c.streaming; })) {
+        const qint64 elapsed = m_sinceCapture.isValid() ? m_sinceCapture.elapsed() : m_minFrameInterval;
+        m_captureTimer->start(int(qMax<qint64>(0, m_minFrameInterval - elapsed)));
+    }
+}
+
+QRect LocalFrameServer::captureRegion() const
+{
+    const QList<QScreen *> screens = QGuiApplication::screens();
+    QRect region;
+    for (QScreen *screen : screens) {
+        if (screen->name() == m_screen) {
+            return screen->geometry();
+        }
+        region |= screen->geometry();
+    }
+    return region;
+}
+
+void LocalFrameServer::captureFrame()
+{
+#ifdef Q_OS_LINUX
+    if (m_damageMonitor->isEventDriven() && !m_dirty) {
+        return;
+    }
+    m_dirty = false;
+    m_sinceCapture.start();
+
+    const QRect region = captureRegion();
+    if (region.isEmpty() || !m_capture) {
+        return;
+    }
+
+    const qint64 cpuStartNs = clockNs(CLOCK_THREAD_CPUTIME_ID);
+    QElapsedTimer timer;
+    timer.start();
+    const QList<CapturedImage> sources = m_capture->grab(region);
+    const qint64 timestampNs = clockNs(CLOCK_MONOTONIC);
+    const qint64 captureUs = timer.nsecsElapsed() / 1000;
+    if (sources.isEmpty()) {
+        return;
+    }
+
+    qreal devicePixelRatio = 1.0;
+    for (const CapturedImage &source : sources) {
+        devicePixelRatio = qMax(devicePixelRatio, source.image.devicePixelRatio());
+    }
+    const QSize size(qCeil(region.width() * devicePixelRatio),
+                     qCeil(region.height() * devicePixelRatio));
+    if (!ensureRing(size)) {
+        return;
+    }
+    for (Consumer &consumer : m_consumers) {
+        if (consumer.streaming && !consumer.announced && !announceRing(consumer)) {
+            // Deferred, disconnecting may remove the consumer right away
+            consumer.streaming = false;
+            QTimer::singleShot(0, consumer.socket, &QLocalSocket::disconnectFromServer);
+        }
+    }
+
+    timer.restart();
+    LocalFrames::SlotHeader *header = slot(m_nextSlot);
+    const quint64 sequence = ++m_sequence * 2;
+    header->sequence.store(sequence - 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    // Captured images are only valid until the next grab, so this copy
+    // into shared memory is the one copy a frame makes
+    const int stride = size.width() * 4;
+    uchar *pixels = reinterpret_cast<uchar *>(header) + sizeof(LocalFrames::SlotHeader);
+    const QImage &first = sources.first().image;
+    if (sources.size() == 1 && first.size() == size
+        && (first.format() == QImage::Format_RGB32 || first.format() == QImage::Format_ARGB32)) {
+        for (int y = 0; y < size.height(); ++y) {
+            memcpy(pixels + size_t(y) * stride, first.constScanLine(y), size_t(stride));
+        }
+    } else {
+        QImage target(pixels, size.width(), size.height(), stride, QImage::Format_RGB32);
+        if (sources.size() > 1) {
+            target.fill(Qt::black);
+        }
+        QPainter painter(&target);
+        painter.scale(qreal(size.width()) / region.width(), qreal(size.height()) / region.height());
+        for (const CapturedImage &source : sources) {
+            painter.drawImage(QRectF(source.target), source.image);
+        }
+    }
+
+    header->timestampNs = quint64(timestampNs);
+    header->x = region.x();
+    header->y = region.y();
+    header->width = quint32(size.width());
+    header->height = quint32(size.height());
+    header->stride = quint32(stride);
+    header->format = LocalFrames::FormatXrgb8888;
+    header->sequence.store(sequence, std::memory_order_release);
+
+    ++m_frames;
+    m_totalCaptureUs += captureUs;
+    m_totalCopyUs += timer.nsecsElapsed() / 1000;
+    m_totalCpuUs += (clockNs(CLOCK_THREAD_CPUTIME_ID) - cpuStartNs) / 1000;
+
+    QJsonObject message;
+    message["type"] = "frame";
+    message["slot"] = m_nextSlot;
+    message["sequence"] = qint64(sequence);
+    for (const Consumer &consumer : m_consumers) {
+        if (!consumer.streaming || !consumer.announced) {
+            continue;
+        }
+        if (consumer.socket->bytesToWrite() > MaxPendingBytes) {
+            ++m_skippedNotifications;
+            continue;
+        }
+        send(consumer.socket, message);
+    }
+    m_nextSlot = (m_nextSlot + 1) % m_slotCount;
+
+    if (m_damageMonitor->isEventDriven() && m_dirty) {
+        m_captureTimer->start(m_minFrameInterval);
+    }
+#endif
+}
+
+void LocalFrameServer::send(QLocalSocket *socket, const QJsonObject &message)
+{
+    socket->write(QJsonDocument(message).toJson(QJsonDocument::Compact) + '\n');
+}
+
+bool LocalFrameServer::announceRing(Consumer &consumer)
+{
+#ifdef Q_OS_LINUX
+    // The descriptor goes out with sendmsg, bypassing the socket's write
+    // buffer; flush that first so messages stay in order
+    QLocalSocket *socket = consumer.socket;
+    if (socket->bytesToWrite() > 0 && !socket->waitForBytesWritten(100)) {
+        qWarning() << "Local consumer is not reading, dropping it";
+        return false;
+    }
+
+    QJsonObject message;
+    message["type"] = "ring";
+    message["size"] = qint64(m_ringSize);
+    message["slots"] = m_slotCount;
+    message["slotStride"] = qint64(m_slotStride);
+    message["dataOffset"] = qint64(PageSize);
+    message["slotHeaderSize"] = int(sizeof(LocalFrames::SlotHeader));
+    message["format"] = "xrgb8888";
+    QByteArray line = QJsonDocument(message).toJson(QJsonDocument::Compact) + '\n';
+
+    iovec iov;
+    iov.iov_base = line.data();
+    iov.iov_len = size_t(line.size());
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+    msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &m_ringFd, sizeof(int));
+
+    if (::sendmsg(int(socket->socketDescriptor()), &msg, MSG_NOSIGNAL) != line.size()) {
+        qWarning() << "Failed to pass the frame ring to a local consumer";
+        return false;
+    }
+    consumer.announced = true;
+    return true;
+#else
+    Q_UNUSED(consumer);
+    return false;
+#endif
+}
+
+bool LocalFrameServer::ensureRing(const QSize &size)
+{
+#ifdef Q_OS_LINUX
+    if (m_ring && size.width() <= m_slotCapacity.width() && size.height() <= m_slotCapacity.height()) {
+        return true;
+    }
+    // Consumers keep their mapping of the old ring until they get the new one
+    releaseRing();
+
+    const size_t pixelBytes = size_t(size.width()) * size_t(size.height()) * 4;
+    m_slotStride = (sizeof(LocalFrames::SlotHeader) + pixelBytes + PageSize - 1) & ~(PageSize - 1);
+    m_ringSize = PageSize + m_slotStride * size_t(m_slotCount);
+
+    m_ringFd = memfd_create("pc-remote-frames", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (m_ringFd < 0 || ftruncate(m_ringFd, off_t(m_ringSize)) != 0) {
+        qWarning() << "Failed to create the frame ring:" << strerror(errno);
+        releaseRing();
+        return false;
+    }
+    void *ring = mmap(nullptr, m_ringSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_ringFd, 0);
+    if (ring == MAP_FAILED) {
+        qWarning() << "Failed to map the frame ring:" << strerror(errno);
+        releaseRing();
+        return false;
+    }
+    m_ring = static_cast<uchar *>(ring);
+
+    // Consumers can rely on the size, and on newer kernels cannot map the
+    // ring writable; the mapping above is unaffected
+    int seals = F_SEAL_SHRINK | F_SEAL_GROW;
+#ifdef F_SEAL_FUTURE_WRITE
+    seals |= F_SEAL_FUTURE_WRITE;
+#endif
+    fcntl(m_ringFd, F_ADD_SEALS, seals | F_SEAL_SEAL);
+
+    auto *header = reinterpret_cast<LocalFrames::RingHeader *>(m_ring);
+    memcpy(header->magic, LocalFrames::Magic, sizeof(header->magic));
+    header->version = LocalFrames::Version;
+    header->slotCount = quint32(m_slotCount);
+    header->slotStride = m_slotStride;
+    header->dataOffset = PageSize;
+    for (int i = 0; i < m_slotCount; ++i) {
+        new (slot(i)) LocalFrames::SlotHeader{};
+    }
+
+    m_slotCapacity = size;
+    m_nextSlot = 0;
+    for (Consumer &consumer : m_consumers) {
+        consumer.announced = false;
+    }
+    return true;
+#else
+    Q_UNUSED(size);
+    return false;
+#endif
+}
+
+void LocalFrameServer::releaseRing()
+{
+#ifdef Q_OS_LINUX
+    if (m_ring) {
+        munmap(m_ring, m_ringSize);
+        m_ring = nullptr;
+    }
+    if (m_ringFd >= 0) {
+        close(m_ringFd);
+        m_ringFd = -1;
+    }
+#endif
+    m_slotCapacity = QSize();
+}
+
+LocalFrames::SlotHeader *LocalFrameServer::slot(int index) const
+{
+    return reinterpret_cast<LocalFrames::SlotHeader *>(m_ring + PageSize + m_slotStride * size_t(index));
+}
+
+QJsonObject LocalFrameServer::stats() const
+{
+    int streaming = 0;
+    for (const Consumer &consumer : m_consumers) {
+        streaming += consumer.streaming ? 1 : 0;
+    }
+
+    QJsonObject stats;
+    stats["consumers"] = m_consumers.size();
+    stats["streaming"] = streaming;
+    stats["scheduling"] = m_damageMonitor->isEventDriven() ? "damage" : "polling";
+    stats["captureBackend"] = m_capture ? m_capture->name() : "";
+    stats["width"] = m_slotCapacity.width();
+    stats["height"] = m_slotCapacity.height();
+    stats["ringBytes"] = qint64(m_ringSize);
+    stats["frames"] = qint64(m_frames);
+    stats["skippedNotifications"] = qint64(m_skippedNotifications);
+    stats["averageCaptureUs"] = m_frames ? m_totalCaptureUs / qint64(m_frames) : 0;
+    stats["averageCopyUs"] = m_frames ? m_totalCopyUs / qint64(m_frames) : 0;
+    stats["averageCpuUs"] = m_frames ? m_totalCpuUs / qint64(m_frames) : 0;
+    return stats;
+}
@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QList>
+#include <QRect>
+#include <QString>
+#include <atomic>
+#include <memory>
+
+class QLocalServer;
+class QLocalSocket;
+class QTimer;
+class CaptureBackend;
+class DamageMonitor;
+
+// Frames for consumers on the same machine, without JPEG, base64 or TCP.
+//
+// Control runs over a Unix domain socket as newline-delimited JSON. On
+// "start" the server passes a memfd holding a ring of raw frames (with
+// SCM_RIGHTS, alongside a "ring" message) and then announces each frame
+// with {"type": "frame", "slot": n, "sequence": s}. Consumers map the memfd
+// once and read pixels in place.
+//
+// Layout, native endian:
+//   0     RingHeader
+//   4096  slot 0: SlotHeader, then height rows of stride bytes (XRGB8888)
+//   ...   slots every slotStride bytes, each 4096 aligned
+//
+// A slot's sequence is odd while it is being written. A consumer that reads
+// the same even sequence before and after copying has an intact frame.
+namespace LocalFrames {
+static const char Magic[8] = { 'P', 'C', 'R', 'R', 'I', 'N', 'G', '\0' };
+static const quint32 Version = 1;
+static const quint32 FormatXrgb8888 = 0;
+
+struct RingHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 slotCount;
+    quint64 slotStride;
+    quint64 dataOffset;
+};
+
+struct SlotHeader
+{
+    std::atomic<quint64> sequence;
+    quint64 timestampNs; // CLOCK_MONOTONIC at capture
+    qint32 x;            // Global logical position of the frame
+    qint32 y;
+    quint32 width;       // Pixels
+    quint32 height;
+    quint32 stride;
+    quint32 format;
+    char reserved[24];
+};
+static_assert(sizeof(SlotHeader) == 64, "slot header is part of the wire format");
+}
+
+class LocalFrameServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LocalFrameServer(QObject *parent = nullptr);
+    ~LocalFrameServer();
+
+    // Only available on Linux; elsewhere this logs and returns false
+    bool listen(const QString &path);
+
+    QJsonObject stats() const;
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+    void onDisconnected();
+    void onDamaged(const QRect &rect);
+    void captureFrame();
+
+private:
+    struct Consumer
+    {
+        QLocalSocket *socket = nullptr;
+        bool streaming = false;
+        bool announced = false;
+    };
+
+    void handleMessage(Consumer &consumer, const QJsonObject &message);
+    void start(Consumer &consumer, const QJsonObject &message);
+    void stop(Consumer &consumer);
+    void updateCapture();
+    void send(QLocalSocket *socket, const QJsonObject &message);
+    bool announceRing(Consumer &consumer);
+    QRect captureRegion() const;
+
+    bool ensureRing(const QSize &size);
+    void releaseRing();
+    LocalFrames::SlotHeader *slot(int index) const;
+
+    QLocalServer *m_server = nullptr;
+    QList<Consumer> m_consumers;
+    QTimer *m_captureTimer;
+    DamageMonitor *m_damageMonitor;
+    std::unique_ptr<CaptureBackend> m_capture;
+    QString m_screen;
+    int m_minFrameInterval = 33;
+    QElapsedTimer m_sinceCapture;
+    bool m_dirty = true;
+
+    int m_ringFd = -1;
+    uchar *m_ring = nullptr;
+    size_t m_ringSize = 0;
+    QSize m_slotCapacity;
+    int m_slotCount = 3;
+    size_t m_slotStride = 0;
+    int m_nextSlot = 0;
+    quint64 m_sequence = 0;
+
+    // Cost of publishing a frame, to compare against screen/stats, which
+    // reports capture plus encode time for the WebSocket path
+    quint64 m_frames = 0;
+    quint64 m_skippedNotifications = 0;
+    qint64 m_totalCaptureUs = 0;
+    qint64 m_totalCopyUs = 0;
+    qint64 m_totalCpuUs = 0;
+};
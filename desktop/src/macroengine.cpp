@@ -0,0 +1,478 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#include "macroengine.h"
+#include "inputcontroller.h"
+#include "mediacontroller.h"
+#include <QDebug>
+#include <QJsonDocument>
+#include <QWebSocket>
+
+// Wheel resolution
+static const qint64 TickNs = 100000;
+// Sleeping is only trusted to wake up this close to a deadline, the rest is
+// spun away
+static const qint64 SpinNs = 200000;
+
+static const int MaxSteps = 1024;
+static const double MaxDelayMs = 60000;
+static const int MaxRepeat = 1000;
+static const int MaxMacros = 64;
+static const int MaxRuns = 256;
+
+static const QStringList MediaActions = { "play_pause", "next", "previous", "volume", "mute" };
+
+static quint64 tickAtOrAfter(qint64 ns)
+{
+    return quint64((ns + TickNs - 1) / TickNs);
+}
+
+MacroEngine::MacroEngine(InputController *input, MediaController *media, QObject *parent)
+    : QObject(parent)
+    , m_input(input)
+    , m_media(media)
+    , m_epoch(std::chrono::steady_clock::now())
+{
+    m_running = true;
+    m_thread = std::thread(&MacroEngine::threadLoop, this);
+}
+
+MacroEngine::~MacroEngine()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+}
+
+void MacroEngine::handleRequest(const QJsonObject &request, QWebSocket *client)
+{
+    QString action = request["action"].toString();
+
+    if (action == "define") {
+        define(request, client);
+    } else if (action == "run") {
+        start(request, client);
+    } else if (action == "stop") {
+        stop(request, client);
+    } else if (action == "list") {
+        list(request, client);
+    } else if (action == "delete") {
+        remove(request, client);
+    } else if (action == "stats") {
+        sendStats(request, client);
+    } else {
+        QJsonObject response;
+        response["status"] = "error";
+        response["message"] = "Unknown macro action";
+        reply(client, request, response);
+    }
+}
+
+void MacroEngine::clientDisconnected(QWebSocket *client)
+{
+    const QList<quint32> runs = m_runs.keys();
+    for (quint32 run : runs) {
+        if (m_runs.value(run).client == client) {
+            cancel(run);
+        }
+    }
+}
+
+void MacroEngine::reattachClient(QWebSocket *from, QWebSocket *to)
+{
+    for (RunInfo &info : m_runs) {
+        if (info.client == from) {
+            info.client = to;
+        }
+    }
+}
+
+void MacroEngine::define(const QJsonObject &request, QWebSocket *client)
+{
+    QJsonObject response;
+    const QString name = request["name"].toString();
+    QString error;
+    ProgramPtr program;
+
+    if (name.isEmpty()) {
+        error = "Missing macro name";
+    } else if (!m_programs.contains(name) && m_programs.size() >= MaxMacros) {
+        error = "Too many macros";
+    } else {
+        program = compile(name, request["steps"].toArray(), &error);
+    }
+
+    if (!program) {
+        response["status"] = "error";
+        response["message"] = error;
+    } else {
+        // Runs already going keep the program they started with
+        m_programs.insert(name, program);
+        response["status"] = "success";
+        response["name"] = name;
+        response["steps"] = int(program->code.size());
+        response["durationMs"] = program->durationUs / 1000.0;
+        qDebug() << "Macro: Defined" << name << "with" << program->code.size() << "steps";
+    }
+    reply(client, request, response);
+}
+
+MacroEngine::ProgramPtr MacroEngine::compile(const QString &name, const QJsonArray &steps, QString *error) const
+{
+    if (steps.isEmpty() || steps.size() > MaxSteps) {
+        *error = QString("A macro needs 1 to %1 steps").arg(MaxSteps);
+        return nullptr;
+    }
+
+    auto program = std::make_shared<Program>();
+    program->name = name;
+    program->code.reserve(steps.size());
+
+    auto intern = [&program](const QString &text) {
+        int index = program->strings.indexOf(text);
+        if (index < 0) {
+            index = program->strings.size();
+            program->strings.append(text);
+        }
+        return index;
+    };
+
+    for (int i = 0; i < steps.size(); ++i) {
+        const QJsonObject step = steps[i].toObject();
+        const QString type = step["type"].toString();
+        const QString action = step["action"].toString();
+        const double delayMs = step["delayMs"].toDouble();
+        if (delayMs < 0 || delayMs > MaxDelayMs) {
+            *error = QString("Step %1: delayMs must be between 0 and %2").arg(i).arg(MaxDelayMs);
+            return nullptr;
+        }
+
+        Instruction instruction{};
+        instruction.delayUs = quint32(qRound64(delayMs * 1000));
+        instruction.text = -1;
+
+        if (type == "input" && action == "mouse_move") {
+            instruction.op = MouseMove;
+            instruction.x = step["deltaX"].toInt();
+            instruction.y = step["deltaY"].toInt();
+        } else if (type == "input" && action == "mouse_click") {
+            instruction.op = MouseClick;
+            instruction.text = intern(step["button"].toString());
+        } else if (type == "input" && action == "key") {
+            instruction.op = Key;
+            instruction.text = intern(step["key"].toString());
+        } else if (type == "input" && action == "text") {
+            instruction.op = Text;
+            instruction.text = intern(step["text"].toString());
+        } else if (type == "media" && MediaActions.contains(action)) {
+            instruction.op = Media;
+            instruction.x = step["value"].toInt();
+            instruction.text = intern(action);
+        } else {
+            *error = QString("Step %1: unsupported step %2/%3").arg(i).arg(type, action);
+            return nullptr;
+        }
+
+        program->durationUs += instruction.delayUs;
+        program->code.push_back(instruction);
+    }
+    return program;
+}
+
+void MacroEngine::start(const QJsonObject &request, QWebSocket *client)
+{
+    QJsonObject response;
+    const QString name = request["name"].toString();
+    const ProgramPtr program = m_programs.value(name);
+    const int repeat = request["repeat"].toInt(1);
+
+    if (!program) {
+        response["status"] = "error";
+        response["message"] = "Unknown macro";
+    } else if (repeat < 1 || repeat > MaxRepeat) {
+        response["status"] = "error";
+        response["message"] = QString("repeat must be between 1 and %1").arg(MaxRepeat);
+    } else if (m_runs.size() >= MaxRuns) {
+        response["status"] = "error";
+        response["message"] = "Too many macros running";
+    } else {
+        const quint32 run = m_nextRun++;
+        m_runs.insert(run, { client, name });
+        post({ run, program, repeat });
+        response["status"] = "success";
+        response["run"] = qint64(run);
+    }
+    reply(client, request, response);
+}
+
+void MacroEngine::stop(const QJsonObject &request, QWebSocket *client)
+{
+    // Without a run, every run the client started is stopped
+    int stopped = 0;
+    const QList<quint32> runs = m_runs.keys();
+    for (quint32 run : runs) {
+        if (m_runs.value(run).client != client) {
+            continue;
+        }
+        if (request.contains("run") && run != quint32(request["run"].toInteger())) {
+            continue;
+        }
+        cancel(run);
+        ++stopped;
+    }
+
+    QJsonObject response;
+    response["status"] = "success";
+    response["stopped"] = stopped;
+    reply(client, request, response);
+}
+
+void MacroEngine::list(const QJsonObject &request, QWebSocket *client)
+{
+    QHash<QString, int> running;
+    for (const RunInfo &info : std::as_const(m_runs)) {
+        ++running[info.name];
+    }
+
+    QJsonArray macros;
+    for (auto it = m_programs.constBegin(); it != m_programs.constEnd(); ++it) {
+        QJsonObject macro;
+        macro["name"] = it.key();
+        macro["steps"] = int(it.value()->code.size());
+        macro["durationMs"] = it.value()->durationUs / 1000.0;
+        macro["running"] = running.value(it.key());
+        macros.append(macro);
+    }
+
+    QJsonObject response;
+    response["status"] = "success";
+    response["macros"] = macros;
+    reply(client, request, response);
+}
+
+void MacroEngine::remove(const QJsonObject &request, QWebSocket *client)
+{
+    QJsonObject response;
+    if (m_programs.remove(request["name"].toString())) {
+        response["status"] = "success";
+    } else {
+        response["status"] = "error";
+        response["message"] = "Unknown macro";
+    }
+    reply(client, request, response);
+}
+
+void MacroEngine::sendStats(const QJsonObject &request, QWebSocket *client)
+{
+    const quint64 wakeups = m_wakeups;
+    QJsonObject stats;
+    stats["macros"] = m_programs.size();
+    stats["runs"] = m_runs.size();
+    stats["steps"] = qint64(m_stepsRun);
+    // Lateness of the macro thread against the ideal step time
+    stats["avgWakeLateUs"] = wakeups ? m_wakeLateTotalNs / qint64(wakeups) / 1000.0 : 0.0;
+    stats["maxWakeLateUs"] = m_wakeLateMaxNs / 1000.0;
+    // Lateness once the GUI thread got to inject the step
+    stats["avgInjectLateUs"] = m_stepsInjected ? m_injectLateTotalNs / qint64(m_stepsInjected) / 1000.0 : 0.0;
+    stats["maxInjectLateUs"] = m_injectLateMaxNs / 1000.0;
+
+    QJsonObject response;
+    response["status"] = "success";
+    response["data"] = stats;
+    reply(client, request, response);
+}
+
+void MacroEngine::reply(QWebSocket *client, const QJsonObject &request, QJsonObject response)
+{
+    response["type"] = "macro";
+    response["action"] = request["action"];
+    response["id"] = request["id"];
+    client->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
+}
+
+void MacroEngine::post(Request &&request)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_requests.push_back(std::move(request));
+    }
+    m_wake.notify_one();
+}
+
+void MacroEngine::cancel(quint32 run)
+{
+    // Steps already handed over are dropped in dispatch()
+    m_runs.remove(run);
+    post({ run, nullptr });
+}
+
+qint64 MacroEngine::nowNs() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_epoch).count();
+}
+
+void MacroEngine::threadLoop()
+{
+    std::vector<Request> requests;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_running) {
+        requests.swap(m_requests);
+        lock.unlock();
+
+        const qint64 now = nowNs();
+        m_wheel.advance(quint64(now / TickNs), [this](quint32 id, quint64) { expire(id); });
+
+        for (Request &request : requests) {
+            if (!request.program) {
+                // The wheel entry stays and finds nothing when it expires
+                m_active.erase(request.run);
+                continue;
+            }
+            Run run;
+            run.program = std::move(request.program);
+            run.remaining = request.repeat;
+            run.dueNs = now + qint64(run.program->code.front().delayUs) * 1000;
+            m_wheel.schedule(request.run, tickAtOrAfter(run.dueNs));
+            m_active.emplace(request.run, std::move(run));
+        }
+        requests.clear();
+
+        const quint64 next = m_wheel.nextTick();
+        lock.lock();
+        if (!m_requests.empty() || !m_running) {
+            continue;
+        }
+        if (next == TimerWheel::NoTick) {
+            m_wake.wait(lock);
+            continue;
+        }
+
+        const auto deadline = m_epoch + std::chrono::nanoseconds(qint64(next) * TickNs);
+        auto woken = [this] { return !m_requests.empty() || !m_running; };
+        if (!m_wheel.hasDue(next)) {
+            // Only moving far entries down a level, no need to be exact
+            m_wake.wait_until(lock, deadline, woken);
+            continue;
+        }
+        if (m_wake.wait_until(lock, deadline - std::chrono::nanoseconds(SpinNs), woken)) {
+            continue;
+        }
+        lock.unlock();
+        while (std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+        lock.lock();
+    }
+}
+
+void MacroEngine::expire(quint32 id)
+{
+    auto it = m_active.find(id);
+    if (it == m_active.end()) {
+        return;
+    }
+    Run &run = it->second;
+    const qint64 now = nowNs();
+
+    const qint64 late = qMax<qint64>(0, now - run.dueNs);
+    ++m_wakeups;
+    m_wakeLateTotalNs += late;
+    m_wakeLateMaxNs = qMax<qint64>(m_wakeLateMaxNs, late);
+
+    // Steps without a delay go out together. Each due time is derived from
+    // the previous ideal one, so lateness never accumulates over a run.
+    for (;;) {
+        emitStep({ id, run.program, run.pc, run.dueNs });
+        ++m_stepsRun;
+
+        if (++run.pc == run.program->code.size()) {
+            run.pc = 0;
+            if (--run.remaining == 0) {
+                emitStep({ id, run.program, run.program->code.size(), run.dueNs });
+                m_active.erase(it);
+                return;
+            }
+        }
+        run.dueNs += qint64(run.program->code[run.pc].delayUs) * 1000;
+        // A new repetition always goes through the wheel, so a macro of
+        // zero delays cannot hold the thread for all its repeats
+        if (run.pc == 0 || run.dueNs > now) {
+            break;
+        }
+    }
+    m_wheel.schedule(id, tickAtOrAfter(run.dueNs));
+}
+
+void MacroEngine::emitStep(Step &&step)
+{
+    bool wasEmpty;
+    {
+        std::lock_guard<std::mutex> lock(m_stepMutex);
+        wasEmpty = m_steps.empty();
+        m_steps.push_back(std::move(step));
+    }
+    if (wasEmpty) {
+        QMetaObject::invokeMethod(this, [this] { dispatch(); }, Qt::QueuedConnection);
+    }
+}
+
+void MacroEngine::dispatch()
+{
+    std::vector<Step> steps;
+    {
+        std::lock_guard<std::mutex> lock(m_stepMutex);
+        steps.swap(m_steps);
+    }
+
+    for (const Step &step : steps) {
+        if (!m_runs.contains(step.run)) {
+            continue; // Stopped
+        }
+        if (step.pc < step.program->code.size()) {
+            execute(*step.program, step.program->code[step.pc]);
+            const qint64 late = qMax<qint64>(0, nowNs() - step.dueNs);
+            ++m_stepsInjected;
+            m_injectLateTotalNs += late;
+            m_injectLateMaxNs = qMax(m_injectLateMaxNs, late);
+            continue;
+        }
+
+        const RunInfo info = m_runs.take(step.run);
+        if (info.client && info.client->isValid()) {
+            QJsonObject message;
+            message["type"] = "macro";
+            message["action"] = "finished";
+            message["run"] = qint64(step.run);
+            message["name"] = info.name;
+            info.client->sendTextMessage(QJsonDocument(message).toJson(QJsonDocument::Compact));
+        }
+    }
+}
+
+void MacroEngine::execute(const Program &program, const Instruction &instruction)
+{
+    const QString text = instruction.text >= 0 ? program.strings[instruction.text] : QString();
+    switch (instruction.op) {
+    case MouseMove:
+        m_input->moveMouse(instruction.x, instruction.y);
+        break;
+    case MouseClick:
+        m_input->mouseClick(text);
+        break;
+    case Key:
+        m_input->sendKey(text);
+        break;
+    case Text:
+        m_input->sendText(text);
+        break;
+    case Media: {
+        QJsonObject data;
+        data["value"] = instruction.x;
+        m_media->handleAction(text, data);
+        break;
+    }
+    }
+}
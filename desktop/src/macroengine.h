@@ -0,0 +1,149 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QPointer>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "timerwheel.h"
+
+class QWebSocket;
+class InputController;
+class MediaController;
+
+// Macros uploaded by clients and played back on the server, so network
+// jitter never reaches the timing of the injected input.
+//
+// A macro is a list of input and media steps, each with a delay relative to
+// the previous one. On upload it is compiled into a flat instruction array.
+// Runs are kept in a timer wheel on a dedicated thread, one entry per run
+// rather than a timer per step; the thread sleeps until the next due tick
+// and spins through the last stretch for sub-millisecond wake-ups. Due
+// steps are handed to the GUI thread, where the input APIs have to run.
+class MacroEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    MacroEngine(InputController *input, MediaController *media, QObject *parent = nullptr);
+    ~MacroEngine();
+
+    void handleRequest(const QJsonObject &request, QWebSocket *client);
+    void clientDisconnected(QWebSocket *client);
+    void reattachClient(QWebSocket *from, QWebSocket *to);
+
+private:
+    enum Op : quint8 { MouseMove, MouseClick, Key, Text, Media };
+
+    struct Instruction
+    {
+        quint32 delayUs;  // After the previous step
+        Op op;
+        qint32 x;         // Mouse delta or media value
+        qint32 y;
+        qint32 text;      // Index into the string table, or -1
+    };
+
+    struct Program
+    {
+        QString name;
+        std::vector<Instruction> code;
+        QStringList strings;
+        qint64 durationUs = 0;
+    };
+    using ProgramPtr = std::shared_ptr<const Program>;
+
+    // Owned by the macro thread
+    struct Run
+    {
+        ProgramPtr program;
+        size_t pc = 0;
+        int remaining = 1;   // Repetitions left, including the current one
+        qint64 dueNs = 0;    // Ideal time of the next step
+    };
+
+    // Sent from the GUI thread to the macro thread
+    struct Request
+    {
+        quint32 run;
+        ProgramPtr program; // Null to cancel
+        int repeat = 1;
+    };
+
+    // Sent from the macro thread to the GUI thread
+    struct Step
+    {
+        quint32 run;
+        ProgramPtr program;
+        size_t pc;          // Out of range when the run finished
+        qint64 dueNs;
+    };
+
+    // GUI side view of a run
+    struct RunInfo
+    {
+        QPointer<QWebSocket> client;
+        QString name;
+    };
+
+    void define(const QJsonObject &request, QWebSocket *client);
+    void start(const QJsonObject &request, QWebSocket *client);
+    void stop(const QJsonObject &request, QWebSocket *client);
+    void list(const QJsonObject &request, QWebSocket *client);
+    void remove(const QJsonObject &request, QWebSocket *client);
+    void sendStats(const QJsonObject &request, QWebSocket *client);
+    void reply(QWebSocket *client, const QJsonObject &request, QJsonObject response);
+    ProgramPtr compile(const QString &name, const QJsonArray &steps, QString *error) const;
+
+    void post(Request &&request);
+    void cancel(quint32 run);
+    void threadLoop();
+    void expire(quint32 id);
+    void emitStep(Step &&step);
+    void dispatch();
+    void execute(const Program &program, const Instruction &instruction);
+    qint64 nowNs() const;
+
+    InputController *m_input;
+    MediaController *m_media;
+    QHash<QString, ProgramPtr> m_programs;
+    QHash<quint32, RunInfo> m_runs;
+    quint32 m_nextRun = 1;
+
+    std::chrono::steady_clock::time_point m_epoch;
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::vector<Request> m_requests;
+
+    // Macro thread only
+    TimerWheel m_wheel;
+    std::unordered_map<quint32, Run> m_active;
+
+    std::mutex m_stepMutex;
+    std::vector<Step> m_steps;
+
+    // How far behind its ideal time a step was picked off the wheel, and
+    // how far behind it was injected on the GUI thread
+    std::atomic<quint64> m_stepsRun{0};
+    std::atomic<quint64> m_wakeups{0};
+    std::atomic<qint64> m_wakeLateTotalNs{0};
+    std::atomic<qint64> m_wakeLateMaxNs{0};
+    qint64 m_injectLateTotalNs = 0;
+    qint64 m_injectLateMaxNs = 0;
+    quint64 m_stepsInjected = 0;
+};
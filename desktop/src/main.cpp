@@ -1,49 +1,304 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 // Copyright (C) 2026 Multi-Function PC Remote Contributors
 
-#include <QApplication>
-#include <QSystemTrayIcon>
-#include <QMenu>
-#include <QMessageBox>
+#include <QGuiApplication>
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <QSettings>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QUrl>
+#include <QHash>
+#include <QDebug>
+#include <memory>
 #include "server.h"
+#include "commandscheduler.h"
+#include "sessionreplay.h"
+#ifdef HAVE_TRAY
+#include "trayicon.h"
+#endif
 
-int main(int argc, char *argv[])
+static const quint16 DefaultPort = 8765;
+
+struct ServerConfig
 {
-    QApplication app(argc, argv);
-    app.setApplicationName("Multi-Function PC Remote");
-    app.setApplicationVersion("1.0.0");
-    app.setQuitOnLastWindowClosed(false);
+    bool headless = false;
+    quint16 port = DefaultPort;
+    QHostAddress bindAddress = QHostAddress::Any;
+    QString recordPath;
+    QString localSocket;
+    QHash<QString, RateLimit> limits;
+};
 
-    if (!QSystemTrayIcon::isSystemTrayAvailable()) {
-        QMessageBox::critical(nullptr, "System Tray",
-                            "System tray is not available on this system.");
-        return 1;
+static bool hasDisplay()
+{
+#if defined(Q_OS_LINUX) || defined(Q_OS_FREEBSD)
+    return qEnvironmentVariableIsSet("DISPLAY")
+        || qEnvironmentVariableIsSet("WAYLAND_DISPLAY")
+        || qEnvironmentVariableIsSet("QT_QPA_PLATFORM");
+#else
+    return true;
+#endif
+}
+
+static bool loadConfig(const QCommandLineParser &parser, ServerConfig &config, QString &error)
+{
+    // Values from the config file are applied first so the command line can override them
+    if (parser.isSet("config")) {
+        QSettings settings(parser.value("config"), QSettings::IniFormat);
+        if (settings.status() != QSettings::NoError) {
+            error = "Failed to read config file " + parser.value("config");
+            return false;
+        }
+        config.headless = settings.value("headless", config.headless).toBool();
+        if (settings.contains("port")) {
+            bool ok = false;
+            const QString value = settings.value("port").toString();
+            const uint port = value.toUInt(&ok);
+            if (!ok || port == 0 || port > 65535) {
+                error = "Invalid port: " + value;
+                return false;
+            }
+            config.port = quint16(port);
+        }
+        config.bindAddress = QHostAddress(settings.value("bind", config.bindAddress.toString()).toString());
+        config.localSocket = settings.value("localSocket", config.localSocket).toString();
+
+        // Per-client command limits, one "rate, burst" pair per command type
+        settings.beginGroup("limits");
+        for (const QString &type : settings.childKeys()) {
+            const QStringList values = settings.value(type).toStringList();
+            bool rateOk = false;
+            bool burstOk = values.size() < 2;
+            RateLimit limit;
+            limit.rate = values.value(0).trimmed().toDouble(&rateOk);
+            limit.burst = values.size() < 2 ? limit.rate : values[1].trimmed().toDouble(&burstOk);
+            if (!rateOk || !burstOk || (limit.rate > 0 && limit.burst < 1)) {
+                error = "Invalid limit for " + type;
+                return false;
+            }
+            config.limits.insert(type, limit);
+        }
+        settings.endGroup();
+    }
+
+    if (parser.isSet("headless")) {
+        config.headless = true;
+    }
+    if (parser.isSet("port")) {
+        bool ok = false;
+        uint port = parser.value("port").toUInt(&ok);
+        if (!ok || port == 0 || port > 65535) {
+            error = "Invalid port: " + parser.value("port");
+            return false;
+        }
+        config.port = quint16(port);
+    }
+    if (parser.isSet("bind")) {
+        config.bindAddress = QHostAddress(parser.value("bind"));
+    }
+    if (parser.isSet("local-socket")) {
+        config.localSocket = parser.value("local-socket");
+    }
+    if (parser.isSet("record")) {
+        config.recordPath = parser.value("record");
+    }
+
+    if (config.bindAddress.isNull()) {
+        error = "Invalid bind address";
+        return false;
+    }
+    return true;
+}
+
+static void logStartup(const QElapsedTimer &startupTimer, bool headless)
+{
+    qInfo().noquote() << QString("Startup completed in %1 ms (%2 mode), RSS %3 kB")
+                             .arg(startupTimer.elapsed())
+                             .arg(headless ? "headless" : "tray")
+                             .arg(Server::residentSetSizeKb());
+}
+
+static bool startServer(Server &server, const ServerConfig &config)
+{
+    for (auto it = config.limits.constBegin(); it != config.limits.constEnd(); ++it) {
+        server.setRateLimit(it.key(), it.value());
     }
+    if (!config.recordPath.isEmpty() && !server.startRecording(config.recordPath)) {
+        return false;
+    }
+    if (!config.localSocket.isEmpty() && !server.startLocalTransport(config.localSocket)) {
+        return false;
+    }
+    return server.start(config.port, config.bindAddress);
+}
+
+// Feeds a recorded session to a dry-run server on a loopback port and
+// reports throughput and dispatch latency
+static int runReplay(int argc, char *argv[], const QString &path, double speed)
+{
+    QCoreApplication app(argc, argv);
 
     Server server;
-    if (!server.start(8765)) {
-        QMessageBox::critical(nullptr, "Server Error",
-                            "Failed to start server on port 8765");
+    server.setDryRun(true);
+    // The limits of a live server would throttle and merge the replayed
+    // commands, and the report would measure them instead of dispatch
+    server.setUnlimited(true);
+    if (!server.start(0, QHostAddress::LocalHost)) {
         return 1;
     }
 
-    QSystemTrayIcon trayIcon;
-    trayIcon.setIcon(QIcon::fromTheme("network-server"));
-    trayIcon.setToolTip("PC Remote Server - Running");
-
-    QMenu trayMenu;
-    QAction *statusAction = trayMenu.addAction("Server: Running on port 8765");
-    statusAction->setEnabled(false);
-    trayMenu.addSeparator();
-    QAction *quitAction = trayMenu.addAction("Quit");
-    
-    QObject::connect(quitAction, &QAction::triggered, &app, &QApplication::quit);
-    
-    trayIcon.setContextMenu(&trayMenu);
-    trayIcon.show();
-    trayIcon.showMessage("PC Remote Server", 
-                        "Server is running on port 8765",
-                        QSystemTrayIcon::Information, 3000);
+    SessionReplay replay;
+    if (!replay.load(path)) {
+        return 1;
+    }
+
+    QObject::connect(&replay, &SessionReplay::finished, &app, [&]() {
+        // Throughput up to the last reply, then the server's own view: the
+        // commands it dispatched in that time, and how many it could
+        // dispatch per second of dispatch time
+        const double seconds = replay.elapsedNs() / 1e9;
+        const QJsonObject status = server.status();
+        const QJsonObject dispatch = status["dispatch"].toObject();
+        const qint64 dispatched = dispatch["count"].toInteger();
+        const double averageUs = dispatch["avgUs"].toDouble();
+        qInfo().noquote() << QString("Replayed %1 messages (%2 bytes) in %3 s: %4 messages/s, %5 replies")
+                                 .arg(replay.messagesSent())
+                                 .arg(replay.bytesSent())
+                                 .arg(seconds, 0, 'f', 3)
+                                 .arg(seconds > 0 ? replay.messagesSent() / seconds : 0.0, 0, 'f', 0)
+                                 .arg(replay.messagesReceived());
+        qInfo().noquote() << QString("Server dispatched %1 commands: %2 commands/s, %3 commands/s of dispatch time")
+                                 .arg(dispatched)
+                                 .arg(seconds > 0 ? dispatched / seconds : 0.0, 0, 'f', 0)
+                                 .arg(averageUs > 0 ? 1e6 / averageUs : 0.0, 0, 'f', 0);
+        qInfo().noquote() << "Server:" << QJsonDocument(status).toJson(QJsonDocument::Compact);
+        app.quit();
+    });
+    replay.start(QUrl(QString("ws://127.0.0.1:%1").arg(server.port())), speed);
 
     return app.exec();
 }
+
+static int runHeadless(int argc, char *argv[], const ServerConfig &config,
+                       const QElapsedTimer &startupTimer)
+{
+    // Screen, input and clipboard features need a GUI application, but only
+    // when a display exists; otherwise fall back to a pure event loop.
+    std::unique_ptr<QCoreApplication> app;
+    if (hasDisplay()) {
+        app = std::make_unique<QGuiApplication>(argc, argv);
+    } else {
+        app = std::make_unique<QCoreApplication>(argc, argv);
+    }
+    app->setApplicationName("Multi-Function PC Remote");
+    app->setApplicationVersion("1.0.0");
+
+    Server server;
+    if (!startServer(server, config)) {
+        qCritical() << "Failed to start server on port" << config.port;
+        return 1;
+    }
+
+    logStartup(startupTimer, true);
+    return app->exec();
+}
+
+#ifdef HAVE_TRAY
+static int runTray(int argc, char *argv[], const ServerConfig &config,
+                   const QElapsedTimer &startupTimer)
+{
+    std::unique_ptr<QCoreApplication> app = TrayIcon::createApplication(argc, argv);
+    app->setApplicationName("Multi-Function PC Remote");
+    app->setApplicationVersion("1.0.0");
+
+    if (!TrayIcon::isAvailable()) {
+        TrayIcon::showError("System Tray",
+                            "System tray is not available on this system.\n"
+                            "Use --headless to run without a tray icon.");
+        return 1;
+    }
+
+    Server server;
+    if (!startServer(server, config)) {
+        TrayIcon::showError("Server Error",
+                            QString("Failed to start server on port %1").arg(config.port));
+        return 1;
+    }
+
+    TrayIcon trayIcon(config.port);
+
+    logStartup(startupTimer, false);
+    return app->exec();
+}
+#endif
+
+int main(int argc, char *argv[])
+{
+    QElapsedTimer startupTimer;
+    startupTimer.start();
+
+    // The command line is parsed before any application object exists because
+    // it decides which kind of application to create.
+    QStringList arguments;
+    for (int i = 0; i < argc; ++i) {
+        arguments << QString::fromLocal8Bit(argv[i]);
+    }
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Multi-Function PC Remote server");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addOptions({
+        {"headless", "Run as a daemon without a system tray icon."},
+        {{"p", "port"}, "Port to listen on (default 8765).", "port"},
+        {{"b", "bind"}, "Address to bind to (default: all interfaces).", "address"},
+        {{"c", "config"}, "Read settings from an INI file.", "file"},
+        {"local-socket", "Serve raw screen frames to local consumers on a Unix socket.", "path"},
+        {"record", "Record all client messages to a session log.", "file"},
+        {"replay", "Replay a session log against a dry-run server and report timings.", "file"},
+        {"replay-speed", "Replay speed factor; 0 replays as fast as possible (default 1).", "factor", "1"},
+    });
+
+    if (!parser.parse(arguments)) {
+        qCritical().noquote() << parser.errorText();
+        return 1;
+    }
+
+    if (parser.isSet("help") || parser.isSet("version")) {
+        QCoreApplication app(argc, argv);
+        app.setApplicationName("Multi-Function PC Remote");
+        app.setApplicationVersion("1.0.0");
+        if (parser.isSet("version")) {
+            parser.showVersion();
+        }
+        parser.showHelp();
+    }
+
+    if (parser.isSet("replay")) {
+        bool ok = false;
+        const double speed = parser.value("replay-speed").toDouble(&ok);
+        if (!ok || speed < 0) {
+            qCritical().noquote() << "Invalid replay speed:" << parser.value("replay-speed");
+            return 1;
+        }
+        return runReplay(argc, argv, parser.value("replay"), speed);
+    }
+
+    ServerConfig config;
+    QString error;
+    if (!loadConfig(parser, config, error)) {
+        qCritical().noquote() << error;
+        return 1;
+    }
+
+#ifdef HAVE_TRAY
+    if (!config.headless) {
+        return runTray(argc, argv, config, startupTimer);
+    }
+#endif
+    // Builds without the tray always run headless
+    return runHeadless(argc, argv, config, startupTimer);
+}
@@ -2,7 +2,14 @@
 // Copyright (C) 2026 Multi-Function PC Remote Contributors
 
 #include "mediacontroller.h"
+#include <QJsonDocument>
+#include <QWebSocket>
 #include <QDebug>
+#include <utility>
+
+#ifdef HAVE_QTDBUS
+#include "mprisclient.h"
+#endif
 
 #ifdef Q_OS_WIN
 #include <windows.h>
@@ -11,8 +18,20 @@
 MediaController::MediaController(QObject *parent)
     : QObject(parent)
 {
+#ifdef HAVE_QTDBUS
+    m_mpris = std::make_unique<MprisClient>();
+    connect(m_mpris.get(), &MprisClient::stateChanged, this, [this](const QJsonObject &delta) {
+        for (QWebSocket *client : std::as_const(m_subscribers)) {
+            if (client->isValid()) {
+                sendState(client, delta);
+            }
+        }
+    });
+#endif
 }
 
+MediaController::~MediaController() = default;
+
 void MediaController::handleAction(const QString &action, const QJsonObject &data)
 {
     if (action == "play_pause") {
@@ -29,11 +48,66 @@ void MediaController::handleAction(const QString &action, const QJsonObject &dat
     }
 }
 
+void MediaController::handleRequest(const QJsonObject &request, QWebSocket *client)
+{
+    QString action = request["action"].toString();
+
+    if (action == "subscribe" && !m_subscribers.contains(client)) {
+        m_subscribers.append(client);
+    } else if (action == "unsubscribe") {
+        m_subscribers.removeAll(client);
+        return;
+    }
+
+    // Both "state" and "subscribe" answer with the full state; subscribers
+    // then only receive the fields that change
+    QJsonObject state;
+#ifdef HAVE_QTDBUS
+    state = m_mpris->state();
+#endif
+    sendState(client, state, request["id"]);
+}
+
+void MediaController::clientDisconnected(QWebSocket *client)
+{
+    m_subscribers.removeAll(client);
+}
+
+void MediaController::reattachClient(QWebSocket *from, QWebSocket *to)
+{
+    const int index = m_subscribers.indexOf(from);
+    if (index < 0) {
+        return;
+    }
+    m_subscribers[index] = to;
+
+    // Changes made while the client was away were not sent
+    QJsonObject state;
+#ifdef HAVE_QTDBUS
+    state = m_mpris->state();
+#endif
+    sendState(to, state);
+}
+
+void MediaController::sendState(QWebSocket *client, const QJsonObject &state, const QJsonValue &id)
+{
+    QJsonObject message;
+    message["type"] = "media";
+    message["action"] = "state";
+    if (!id.isUndefined()) {
+        message["id"] = id;
+    }
+    message["data"] = state;
+    client->sendTextMessage(QJsonDocument(message).toJson(QJsonDocument::Compact));
+}
+
 void MediaController::playPause()
 {
 #ifdef Q_OS_WIN
     keybd_event(VK_MEDIA_PLAY_PAUSE, 0, 0, 0);
     keybd_event(VK_MEDIA_PLAY_PAUSE, 0, KEYEVENTF_KEYUP, 0);
+#elif defined(HAVE_QTDBUS)
+    m_mpris->callPlayer("PlayPause");
 #endif
     qDebug() << "Media: Play/Pause";
 }
@@ -43,6 +117,8 @@ void MediaController::nextTrack()
 #ifdef Q_OS_WIN
     keybd_event(VK_MEDIA_NEXT_TRACK, 0, 0, 0);
     keybd_event(VK_MEDIA_NEXT_TRACK, 0, KEYEVENTF_KEYUP, 0);
+#elif defined(HAVE_QTDBUS)
+    m_mpris->callPlayer("Next");
 #endif
     qDebug() << "Media: Next Track";
 }
@@ -52,6 +128,8 @@ void MediaController::previousTrack()
 #ifdef Q_OS_WIN
     keybd_event(VK_MEDIA_PREV_TRACK, 0, 0, 0);
     keybd_event(VK_MEDIA_PREV_TRACK, 0, KEYEVENTF_KEYUP, 0);
+#elif defined(HAVE_QTDBUS)
+    m_mpris->callPlayer("Previous");
 #endif
     qDebug() << "Media: Previous Track";
 }
@@ -59,6 +137,10 @@ void MediaController::previousTrack()
 void MediaController::setVolume(int volume)
 {
     // Volume control implementation
+#ifdef HAVE_QTDBUS
+    // MPRIS volume is the player's own, from 0.0 to 1.0
+    m_mpris->setVolume(volume / 100.0);
+#endif
     qDebug() << "Media: Set Volume to" << volume;
 }
 
@@ -67,6 +149,15 @@ void MediaController::mute()
 #ifdef Q_OS_WIN
     keybd_event(VK_VOLUME_MUTE, 0, 0, 0);
     keybd_event(VK_VOLUME_MUTE, 0, KEYEVENTF_KEYUP, 0);
+#elif defined(HAVE_QTDBUS)
+    // MPRIS has no mute, so toggle between silence and the previous volume
+    if (m_volumeBeforeMute < 0) {
+        m_volumeBeforeMute = m_mpris->volume();
+        m_mpris->setVolume(0.0);
+    } else {
+        m_mpris->setVolume(m_volumeBeforeMute);
+        m_volumeBeforeMute = -1;
+    }
 #endif
     qDebug() << "Media: Mute Toggle";
 }
@@ -5,6 +5,11 @@
 
 #include <QObject>
 #include <QJsonObject>
+#include <QList>
+#include <memory>
+
+class QWebSocket;
+class MprisClient;
 
 class MediaController : public QObject
 {
@@ -12,8 +17,14 @@ class MediaController : public QObject
 
 public:
     explicit MediaController(QObject *parent = nullptr);
+    ~MediaController();
     
     void handleAction(const QString &action, const QJsonObject &data);
+    // Player state queries and the "subscribe"/"unsubscribe" actions,
+    // which answer the client directly
+    void handleRequest(const QJsonObject &request, QWebSocket *client);
+    void clientDisconnected(QWebSocket *client);
+    void reattachClient(QWebSocket *from, QWebSocket *to);
 
 private:
     void playPause();
@@ -21,4 +32,11 @@ private:
     void previousTrack();
     void setVolume(int volume);
     void mute();
+    void sendState(QWebSocket *client, const QJsonObject &state, const QJsonValue &id = QJsonValue(QJsonValue::Undefined));
+
+#ifdef HAVE_QTDBUS
+    std::unique_ptr<MprisClient> m_mpris;
+    double m_volumeBeforeMute = -1;
+#endif
+    QList<QWebSocket *> m_subscribers;
 };
@@ -0,0 +1,275 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#include "mprisclient.h"
+#include <QDBusArgument>
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QDBusVariant>
+#include <QDateTime>
+#include <QJsonArray>
+#include <QTimer>
+#include <QDebug>
+
+static const QString ServicePrefix = QStringLiteral("org.mpris.MediaPlayer2.");
+static const QString ObjectPath = QStringLiteral("/org/mpris/MediaPlayer2");
+static const QString PlayerInterface = QStringLiteral("org.mpris.MediaPlayer2.Player");
+static const QString PropertiesInterface = QStringLiteral("org.freedesktop.DBus.Properties");
+
+// Nested a{sv} values arrive as QDBusArgument when unmarshalled generically
+static QVariantMap toVariantMap(const QVariant &value)
+{
+    if (value.canConvert<QDBusArgument>()) {
+        return qdbus_cast<QVariantMap>(value.value<QDBusArgument>());
+    }
+    return value.toMap();
+}
+
+static QJsonObject metadataToJson(const QVariantMap &metadata)
+{
+    QJsonObject track;
+    track["title"] = metadata.value("xesam:title").toString();
+    track["artist"] = QJsonArray::fromStringList(metadata.value("xesam:artist").toStringList());
+    track["album"] = metadata.value("xesam:album").toString();
+    track["artUrl"] = metadata.value("mpris:artUrl").toString();
+    track["lengthUs"] = metadata.value("mpris:length").toLongLong();
+    track["trackId"] = metadata.value("mpris:trackid").value<QDBusObjectPath>().path();
+    return track;
+}
+
+MprisClient::MprisClient(QObject *parent)
+    : QObject(parent)
+{
+    QDBusConnection bus = QDBusConnection::sessionBus();
+    if (!bus.isConnected()) {
+        qWarning() << "MPRIS: session bus not available";
+        return;
+    }
+
+    bus.connect("org.freedesktop.DBus", "/org/freedesktop/DBus", "org.freedesktop.DBus",
+                "NameOwnerChanged", this,
+                SLOT(onNameOwnerChanged(QString,QString,QString)));
+
+    // An empty service matches every sender, so one subscription covers
+    // players that appear later as well
+    bus.connect(QString(), ObjectPath, PropertiesInterface, "PropertiesChanged",
+                this, SLOT(onPropertiesChanged(QDBusMessage)));
+    bus.connect(QString(), ObjectPath, PlayerInterface, "Seeked",
+                this, SLOT(onSeeked(QDBusMessage)));
+
+    const QStringList services = bus.interface()->registeredServiceNames().value();
+    for (const QString &service : services) {
+        if (service.startsWith(ServicePrefix)) {
+            addPlayer(service, bus.interface()->serviceOwner(service).value());
+        }
+    }
+}
+
+bool MprisClient::isAvailable() const
+{
+    return !m_active.isEmpty();
+}
+
+void MprisClient::callPlayer(const QString &method)
+{
+    if (m_active.isEmpty()) {
+        return;
+    }
+    QDBusMessage message = QDBusMessage::createMethodCall(m_active, ObjectPath, PlayerInterface, method);
+    QDBusConnection::sessionBus().asyncCall(message);
+}
+
+void MprisClient::setVolume(double volume)
+{
+    if (m_active.isEmpty()) {
+        return;
+    }
+    QDBusMessage message = QDBusMessage::createMethodCall(m_active, ObjectPath, PropertiesInterface, "Set");
+    message << PlayerInterface << QStringLiteral("Volume")
+            << QVariant::fromValue(QDBusVariant(qBound(0.0, volume, 1.0)));
+    QDBusConnection::sessionBus().asyncCall(message);
+}
+
+double MprisClient::volume() const
+{
+    return m_players.value(m_active).state.value("volume").toDouble();
+}
+
+QJsonObject MprisClient::state() const
+{
+    QJsonObject state = m_players.value(m_active).state;
+    state["player"] = m_active.mid(ServicePrefix.size());
+    return state;
+}
+
+void MprisClient::onNameOwnerChanged(const QString &name, const QString &oldOwner, const QString &newOwner)
+{
+    if (!name.startsWith(ServicePrefix)) {
+        return;
+    }
+    Q_UNUSED(oldOwner);
+
+    if (newOwner.isEmpty()) {
+        m_players.remove(name);
+        if (name == m_active) {
+            chooseActivePlayer();
+        }
+        return;
+    }
+    addPlayer(name, newOwner);
+}
+
+void MprisClient::addPlayer(const QString &service, const QString &owner)
+{
+    m_players[service].owner = owner;
+    if (m_active.isEmpty()) {
+        m_active = service;
+    }
+    fetchProperties(service);
+}
+
+void MprisClient::fetchProperties(const QString &service)
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(service, ObjectPath, PropertiesInterface, "GetAll");
+    message << PlayerInterface;
+
+    auto *watcher = new QDBusPendingCallWatcher(QDBusConnection::sessionBus().asyncCall(message), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, service](QDBusPendingCallWatcher *call) {
+        QDBusPendingReply<QVariantMap> reply = *call;
+        if (reply.isError()) {
+            qWarning() << "MPRIS: failed to read properties of" << service << reply.error().message();
+        } else if (m_players.contains(service)) {
+            applyProperties(service, reply.value());
+        }
+        call->deleteLater();
+    });
+}
+
+QString MprisClient::serviceForOwner(const QString &owner) const
+{
+    for (auto it = m_players.cbegin(); it != m_players.cend(); ++it) {
+        if (it->owner == owner) {
+            return it.key();
+        }
+    }
+    return QString();
+}
+
+void MprisClient::onPropertiesChanged(const QDBusMessage &message)
+{
+    const QList<QVariant> arguments = message.arguments();
+    if (arguments.size() < 2 || arguments[0].toString() != PlayerInterface) {
+        return;
+    }
+
+    const QString service = serviceForOwner(message.service());
+    if (service.isEmpty()) {
+        return;
+    }
+
+    applyProperties(service, toVariantMap(arguments[1]));
+
+    // Invalidated properties come without values and must be re-read
+    if (arguments.size() > 2 && !arguments[2].toStringList().isEmpty()) {
+        fetchProperties(service);
+    }
+}
+
+void MprisClient::onSeeked(const QDBusMessage &message)
+{
+    const QString service = serviceForOwner(message.service());
+    if (service.isEmpty() || message.arguments().isEmpty()) {
+        return;
+    }
+
+    QVariantMap properties;
+    properties["Position"] = message.arguments().first();
+    applyProperties(service, properties);
+}
+
+void MprisClient::applyProperties(const QString &service, const QVariantMap &properties)
+{
+    QJsonObject &state = m_players[service].state;
+
+    for (auto it = properties.cbegin(); it != properties.cend(); ++it) {
+        const QString &key = it.key();
+        if (key == "PlaybackStatus") {
+            state["status"] = it.value().toString();
+        } else if (key == "Metadata") {
+            state["track"] = metadataToJson(toVariantMap(it.value()));
+        } else if (key == "Volume") {
+            state["volume"] = it.value().toDouble();
+        } else if (key == "Rate") {
+            state["rate"] = it.value().toDouble();
+        } else if (key == "Shuffle") {
+            state["shuffle"] = it.value().toBool();
+        } else if (key == "LoopStatus") {
+            state["loop"] = it.value().toString();
+        } else if (key == "CanGoNext") {
+            state["canGoNext"] = it.value().toBool();
+        } else if (key == "CanGoPrevious") {
+            state["canGoPrevious"] = it.value().toBool();
+        } else if (key == "Position") {
+            // Players do not signal position while playing; clients
+            // extrapolate from the position, the rate and when it was taken
+            state["positionUs"] = it.value().toLongLong();
+            state["positionAt"] = QDateTime::currentMSecsSinceEpoch();
+        }
+    }
+
+    if (state.value("status").toString() == "Playing" && service != m_active) {
+        m_active = service;
+    }
+
+    if (service == m_active) {
+        schedulePublish();
+    }
+}
+
+void MprisClient::chooseActivePlayer()
+{
+    m_active.clear();
+    for (auto it = m_players.cbegin(); it != m_players.cend(); ++it) {
+        if (m_active.isEmpty() || it->state.value("status").toString() == "Playing") {
+            m_active = it.key();
+        }
+    }
+    schedulePublish();
+}
+
+void MprisClient::schedulePublish()
+{
+    // Players usually emit several PropertiesChanged signals for one track
+    // change; send them as a single delta
+    if (m_publishPending) {
+        return;
+    }
+    m_publishPending = true;
+    QTimer::singleShot(0, this, &MprisClient::publish);
+}
+
+void MprisClient::publish()
+{
+    m_publishPending = false;
+
+    const QJsonObject current = state();
+    QJsonObject delta;
+    for (auto it = current.constBegin(); it != current.constEnd(); ++it) {
+        if (m_published.value(it.key()) != it.value()) {
+            delta[it.key()] = it.value();
+        }
+    }
+    for (auto it = m_published.constBegin(); it != m_published.constEnd(); ++it) {
+        if (!current.contains(it.key())) {
+            delta[it.key()] = QJsonValue::Null;
+        }
+    }
+
+    m_published = current;
+    if (!delta.isEmpty()) {
+        emit stateChanged(delta);
+    }
+}
@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QJsonObject>
+#include <QString>
+#include <QVariantMap>
+
+class QDBusMessage;
+
+// Talks to media players over MPRIS on the session bus. Player properties
+// are cached from PropertiesChanged signals rather than polled, and changes
+// are coalesced into one stateChanged() per event-loop pass carrying only
+// the fields that differ from the last published state.
+class MprisClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MprisClient(QObject *parent = nullptr);
+
+    bool isAvailable() const;
+
+    // Method on org.mpris.MediaPlayer2.Player of the active player,
+    // e.g. "PlayPause", "Next" or "Previous"
+    void callPlayer(const QString &method);
+    void setVolume(double volume);
+    double volume() const;
+
+    // Full state of the active player
+    QJsonObject state() const;
+
+signals:
+    void stateChanged(const QJsonObject &delta);
+
+private slots:
+    void onNameOwnerChanged(const QString &name, const QString &oldOwner, const QString &newOwner);
+    void onPropertiesChanged(const QDBusMessage &message);
+    void onSeeked(const QDBusMessage &message);
+
+private:
+    struct Player
+    {
+        QString owner; // Unique bus name signals are sent from
+        QJsonObject state;
+    };
+
+    void addPlayer(const QString &service, const QString &owner);
+    void fetchProperties(const QString &service);
+    void applyProperties(const QString &service, const QVariantMap &properties);
+    void chooseActivePlayer();
+    void schedulePublish();
+    void publish();
+    QString serviceForOwner(const QString &owner) const;
+
+    QHash<QString, Player> m_players; // Keyed by well-known service name
+    QString m_active;
+    QJsonObject m_published;
+    bool m_publishPending = false;
+};
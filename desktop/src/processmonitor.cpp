@@ -0,0 +1,518 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#include "processmonitor.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QTimer>
+#include <QWebSocket>
+#include <QDebug>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#ifdef Q_OS_LINUX
+#include <dirent.h>
+#include <pwd.h>
+#include <signal.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+static const int MinIntervalMs = 500;
+static const int MaxIntervalMs = 60000;
+static const int MaxPageSize = 500;
+static const int MaxCommandLength = 256;
+
+ProcessMonitor::ProcessMonitor(QObject *parent)
+    : QObject(parent)
+    , m_timer(new QTimer(this))
+{
+    connect(m_timer, &QTimer::timeout, this, &ProcessMonitor::scan);
+    m_clock.start();
+#ifdef Q_OS_LINUX
+    m_ticksPerSecond = sysconf(_SC_CLK_TCK);
+#endif
+}
+
+ProcessMonitor::~ProcessMonitor() = default;
+
+void ProcessMonitor::handleRequest(const QJsonObject &request, QWebSocket *client)
+{
+    QString action = request["action"].toString();
+
+    if (action == "subscribe") {
+        subscribe(request, client);
+    } else if (action == "unsubscribe") {
+        clientDisconnected(client);
+    } else if (action == "page") {
+        // Change sorting or paging of an existing subscription
+        for (Subscriber &subscriber : m_subscribers) {
+            if (subscriber.client == client) {
+                configure(subscriber, request);
+                publish(subscriber, request["id"]);
+            }
+        }
+    } else if (action == "list") {
+        if (!m_timer->isActive() && !scanProcesses()) {
+            sendUnavailable(request, client);
+            return;
+        }
+        Subscriber once;
+        once.client = client;
+        configure(once, request);
+        publish(once, request["id"]);
+    } else if (action == "kill") {
+        kill(request, client);
+    } else if (action == "stats") {
+        sendStats(client);
+    }
+}
+
+void ProcessMonitor::clientDisconnected(QWebSocket *client)
+{
+    for (int i = m_subscribers.size() - 1; i >= 0; --i) {
+        if (m_subscribers[i].client == client) {
+            m_subscribers.removeAt(i);
+        }
+    }
+    updateTimer();
+}
+
+void ProcessMonitor::reattachClient(QWebSocket *from, QWebSocket *to)
+{
+    for (Subscriber &subscriber : m_subscribers) {
+        if (subscriber.client == from) {
+            // Resend the whole page; its "order" tells the client which
+            // rows it holds are gone
+            subscriber.client = to;
+            subscriber.sent.clear();
+            subscriber.order.clear();
+            publish(subscriber);
+        }
+    }
+}
+
+void ProcessMonitor::subscribe(const QJsonObject &request, QWebSocket *client)
+{
+    clientDisconnected(client);
+
+    if (!m_timer->isActive() && !scanProcesses()) {
+        sendUnavailable(request, client);
+        return;
+    }
+
+    Subscriber subscriber;
+    subscriber.client = client;
+    subscriber.intervalMs = qBound(MinIntervalMs, request["intervalMs"].toInt(1000), MaxIntervalMs);
+    subscriber.nextDue = m_clock.elapsed() + subscriber.intervalMs;
+    configure(subscriber, request);
+    m_subscribers.append(subscriber);
+    publish(m_subscribers.last(), request["id"]);
+    updateTimer();
+}
+
+void ProcessMonitor::configure(Subscriber &subscriber, const QJsonObject &request)
+{
+    const QString sort = request["sort"].toString("cpu");
+    if (sort == "memory") {
+        subscriber.sort = SortMemory;
+    } else if (sort == "pid") {
+        subscriber.sort = SortPid;
+    } else if (sort == "name") {
+        subscriber.sort = SortName;
+    } else {
+        subscriber.sort = SortCpu;
+    }
+    // Busiest first, but pids and names read naturally in ascending order
+    const bool defaultDescending = subscriber.sort == SortCpu || subscriber.sort == SortMemory;
+    subscriber.descending = request["descending"].toBool(defaultDescending);
+    subscriber.offset = qMax(0, request["offset"].toInt(0));
+    subscriber.limit = qBound(1, request["limit"].toInt(50), MaxPageSize);
+}
+
+void ProcessMonitor::updateTimer()
+{
+    if (m_subscribers.isEmpty()) {
+        m_timer->stop();
+        return;
+    }
+
+    int interval = MaxIntervalMs;
+    for (const Subscriber &subscriber : std::as_const(m_subscribers)) {
+        interval = qMin(interval, subscriber.intervalMs);
+    }
+    if (!m_timer->isActive() || m_timer->interval() != interval) {
+        m_timer->start(interval);
+    }
+}
+
+void ProcessMonitor::scan()
+{
+    scanProcesses();
+
+    const qint64 now = m_clock.elapsed();
+    for (Subscriber &subscriber : m_subscribers) {
+        if (now + m_timer->interval() / 2 < subscriber.nextDue || !subscriber.client->isValid()) {
+            continue;
+        }
+        subscriber.nextDue = qMax(subscriber.nextDue + subscriber.intervalMs, now);
+        publish(subscriber);
+    }
+}
+
+bool ProcessMonitor::scanProcesses()
+{
+#ifdef Q_OS_LINUX
+    QElapsedTimer timer;
+    timer.start();
+
+    DIR *proc = opendir("/proc");
+    if (!proc) {
+        return false;
+    }
+
+    ++m_scan;
+    const qint64 now = m_clock.nsecsElapsed();
+    const double seconds = m_lastScanAt >= 0 ? (now - m_lastScanAt) / 1e9 : 0.0;
+    m_lastScanAt = now;
+
+    char path[64];
+    while (dirent *entry = readdir(proc)) {
+        if (entry->d_name[0] < '0' || entry->d_name[0] > '9') {
+            continue;
+        }
+        const int pid = atoi(entry->d_name);
+
+        const int length = snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+        if (!m_file.open(QByteArray::fromRawData(path, length))) {
+            continue; // Exited since readdir
+        }
+        const char *text = m_file.read();
+        if (!text) {
+            m_file.close();
+            continue;
+        }
+
+        auto it = m_processes.find(pid);
+        const bool fresh = it == m_processes.end();
+        if (fresh) {
+            it = m_processes.insert(pid, Process());
+            it->pid = pid;
+        }
+
+        const quint64 previousTicks = it->cpuTicks;
+        const bool reused = !readStat(*it, text, fresh);
+        m_file.close();
+
+        if (fresh || reused) {
+            readStaticFields(*it);
+            it->cpu = 0;
+        } else if (seconds > 0) {
+            it->cpu = 100.0 * (it->cpuTicks - previousTicks) / m_ticksPerSecond / seconds;
+        }
+        it->seenScan = m_scan;
+    }
+    closedir(proc);
+
+    for (auto it = m_processes.begin(); it != m_processes.end();) {
+        if (it->seenScan != m_scan) {
+            it = m_processes.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    m_lastScanNs = timer.nsecsElapsed();
+    m_scanNs += m_lastScanNs;
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Parses /proc/[pid]/stat. Returns false when the pid now belongs to a
+// different process than the one cached.
+bool ProcessMonitor::readStat(Process &process, const char *text, bool fresh)
+{
+    // "pid (comm) state ppid ..."; comm may itself contain spaces and ')'
+    const char *open = strchr(text, '(');
+    const char *close = strrchr(text, ')');
+    if (!open || !close || close < open) {
+        return true;
+    }
+
+    const char *cursor = ProcFile::skipSpaces(close + 1);
+    const char state = *cursor++;
+    const int ppid = int(ProcFile::parseNumber(cursor));
+    cursor = ProcFile::skipFields(cursor, 9);                   // pgrp .. cmajflt
+    const quint64 utime = ProcFile::parseNumber(cursor);
+    const quint64 stime = ProcFile::parseNumber(cursor);
+    cursor = ProcFile::skipFields(cursor, 4);                   // cutime .. nice
+    const int threads = int(ProcFile::parseNumber(cursor));
+    cursor = ProcFile::skipFields(cursor, 1);                   // itrealvalue
+    const quint64 startTime = ProcFile::parseNumber(cursor);
+    cursor = ProcFile::skipFields(cursor, 1);                   // vsize
+    const qint64 rssPages = ProcFile::parseSigned(cursor);
+
+    bool samePid = true;
+    if (!fresh && startTime != process.startTime) {
+        const int pid = process.pid;
+        process = Process();
+        process.pid = pid;
+        samePid = false;
+    }
+    if (fresh || !samePid) {
+        process.name = QString::fromLocal8Bit(open + 1, int(close - open - 1));
+    }
+
+    process.state = state;
+    process.ppid = ppid;
+    process.cpuTicks = utime + stime;
+    process.threads = threads;
+    process.startTime = startTime;
+#ifdef Q_OS_LINUX
+    static const long pageKb = sysconf(_SC_PAGESIZE) / 1024;
+    process.rssKb = rssPages * pageKb;
+#else
+    process.rssKb = rssPages * 4;
+#endif
+    return samePid;
+}
+
+void ProcessMonitor::readStaticFields(Process &process)
+{
+#ifdef Q_OS_LINUX
+    ++m_staticReads;
+    char path[64];
+
+    snprintf(path, sizeof(path), "/proc/%d/cmdline", process.pid);
+    const char *text = m_file.open(path) ? m_file.read() : nullptr;
+    if (text) {
+        // Arguments are separated by nulls
+        QByteArray command(text, qMin(m_file.size(), qsizetype(MaxCommandLength)));
+        while (command.endsWith('\0')) {
+            command.chop(1);
+        }
+        command.replace('\0', ' ');
+        process.command = QString::fromLocal8Bit(command);
+    }
+    m_file.close();
+    if (process.command.isEmpty()) {
+        process.command = '[' + process.name + ']'; // Kernel thread
+    }
+
+    snprintf(path, sizeof(path), "/proc/%d/status", process.pid);
+    text = m_file.open(path) ? m_file.read() : nullptr;
+    if (text) {
+        const char *uidLine = text ? ProcFile::findLine(text, "Uid:") : nullptr;
+        if (uidLine) {
+            uidLine += 4;
+            process.user = userName(uint(ProcFile::parseNumber(uidLine)));
+        }
+    }
+    m_file.close();
+#else
+    Q_UNUSED(process);
+#endif
+}
+
+QString ProcessMonitor::userName(uint uid)
+{
+    auto it = m_users.constFind(uid);
+    if (it != m_users.constEnd()) {
+        return *it;
+    }
+
+    QString name = QString::number(uid);
+#ifdef Q_OS_LINUX
+    if (const passwd *entry = getpwuid(uid)) {
+        name = QString::fromLocal8Bit(entry->pw_name);
+    }
+#endif
+    m_users.insert(uid, name);
+    return name;
+}
+
+QJsonObject ProcessMonitor::row(const Process &process) const
+{
+    QJsonObject row;
+    row["pid"] = process.pid;
+    row["ppid"] = process.ppid;
+    row["name"] = process.name;
+    row["command"] = process.command;
+    row["user"] = process.user;
+    row["state"] = QString(QChar(process.state));
+    row["cpu"] = qRound(process.cpu * 10) / 10.0;
+    row["memKb"] = process.rssKb;
+    row["threads"] = process.threads;
+    return row;
+}
+
+void ProcessMonitor::publish(Subscriber &subscriber, const QJsonValue &id)
+{
+    m_sorted.clear();
+    m_sorted.reserve(m_processes.size());
+    for (const Process &process : std::as_const(m_processes)) {
+        m_sorted.push_back(&process);
+    }
+
+    const SortKey key = subscriber.sort;
+    const bool descending = subscriber.descending;
+    auto less = [key, descending](const Process *a, const Process *b) {
+        if (descending) {
+            std::swap(a, b);
+        }
+        switch (key) {
+        case SortCpu:
+            if (a->cpu != b->cpu)
+                return a->cpu < b->cpu;
+            break;
+        case SortMemory:
+            if (a->rssKb != b->rssKb)
+                return a->rssKb < b->rssKb;
+            break;
+        case SortName: {
+            const int order = a->name.compare(b->name, Qt::CaseInsensitive);
+            if (order != 0)
+                return order < 0;
+            break;
+        }
+        case SortPid:
+            break;
+        }
+        return a->pid < b->pid;
+    };
+
+    // Only the requested page needs to be in order
+    const size_t begin = qMin(size_t(subscriber.offset), m_sorted.size());
+    const size_t end = qMin(begin + size_t(subscriber.limit), m_sorted.size());
+    std::partial_sort(m_sorted.begin(), m_sorted.begin() + end, m_sorted.end(), less);
+
+    QJsonArray added;
+    QJsonArray changed;
+    QJsonArray removed;
+    QHash<int, QJsonObject> rows;
+    QList<int> order;
+    rows.reserve(int(end - begin));
+    order.reserve(int(end - begin));
+
+    for (size_t i = begin; i < end; ++i) {
+        const Process &process = *m_sorted[i];
+        const QJsonObject current = row(process);
+        order.append(process.pid);
+        rows.insert(process.pid, current);
+
+        auto previous = subscriber.sent.constFind(process.pid);
+        if (previous == subscriber.sent.constEnd()) {
+            added.append(current);
+            continue;
+        }
+
+        QJsonObject delta;
+        for (auto it = current.constBegin(); it != current.constEnd(); ++it) {
+            if (previous->value(it.key()) != it.value()) {
+                delta[it.key()] = it.value();
+            }
+        }
+        if (!delta.isEmpty()) {
+            delta["pid"] = process.pid;
+            changed.append(delta);
+        }
+    }
+    for (auto it = subscriber.sent.constBegin(); it != subscriber.sent.constEnd(); ++it) {
+        if (!rows.contains(it.key())) {
+            removed.append(it.key());
+        }
+    }
+
+    const bool reply = !id.isUndefined();
+    const bool reordered = order != subscriber.order;
+    if (!reply && !reordered && added.isEmpty() && changed.isEmpty() && removed.isEmpty()) {
+        return;
+    }
+    subscriber.sent = rows;
+    subscriber.order = order;
+
+    QJsonObject message;
+    message["type"] = "process";
+    message["action"] = "update";
+    if (reply) {
+        message["id"] = id;
+    }
+    message["total"] = int(m_processes.size());
+    message["offset"] = int(begin);
+    if (!added.isEmpty())
+        message["added"] = added;
+    if (!changed.isEmpty())
+        message["changed"] = changed;
+    if (!removed.isEmpty())
+        message["removed"] = removed;
+    if (reordered || reply) {
+        QJsonArray pids;
+        for (int pid : std::as_const(order)) {
+            pids.append(pid);
+        }
+        message["order"] = pids;
+    }
+    subscriber.client->sendTextMessage(QJsonDocument(message).toJson(QJsonDocument::Compact));
+}
+
+void ProcessMonitor::kill(const QJsonObject &request, QWebSocket *client)
+{
+    QJsonObject response;
+    response["type"] = "process";
+    response["action"] = "kill";
+    response["id"] = request["id"];
+
+    const int pid = request["pid"].toInt();
+#ifdef Q_OS_LINUX
+    if (pid <= 1 || pid == getpid()) {
+        response["status"] = "error";
+        response["message"] = "Refusing to signal this process";
+    } else {
+        // "term" asks the process to exit, "kill" cannot be ignored
+        const int signalNumber = request["signal"].toString("term") == "kill" ? SIGKILL : SIGTERM;
+        if (::kill(pid, signalNumber) == 0) {
+            response["status"] = "success";
+            qDebug() << "Process: Sent" << (signalNumber == SIGKILL ? "SIGKILL" : "SIGTERM") << "to" << pid;
+        } else {
+            response["status"] = "error";
+            response["message"] = QString::fromLocal8Bit(strerror(errno));
+        }
+    }
+#else
+    Q_UNUSED(pid);
+    response["status"] = "error";
+    response["message"] = "Process control is not available on this system";
+#endif
+    client->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
+}
+
+void ProcessMonitor::sendStats(QWebSocket *client)
+{
+    QJsonObject stats;
+    stats["subscribers"] = m_subscribers.size();
+    stats["processes"] = int(m_processes.size());
+    stats["scans"] = qint64(m_scan);
+    stats["lastScanUs"] = m_lastScanNs / 1000;
+    stats["avgScanUs"] = m_scan ? m_scanNs / qint64(m_scan) / 1000 : 0;
+    // Processes whose command line and owner had to be read
+    stats["staticReads"] = qint64(m_staticReads);
+
+    QJsonObject response;
+    response["type"] = "process";
+    response["action"] = "stats";
+    response["data"] = stats;
+    client->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
+}
+
+void ProcessMonitor::sendUnavailable(const QJsonObject &request, QWebSocket *client)
+{
+    QJsonObject response;
+    response["type"] = "process";
+    response["id"] = request["id"];
+    response["status"] = "error";
+    response["message"] = "Process list is not available on this system";
+    client->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
+}
@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#pragma once
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <vector>
+#include "procfile.h"
+
+class QTimer;
+class QWebSocket;
+
+// Task manager backend. /proc is scanned incrementally: command line and
+// owner are read once per process, later scans only re-read
+// /proc/[pid]/stat. Each subscriber sees one sorted page of the table and
+// is sent the rows that were added, removed or changed on that page.
+class ProcessMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ProcessMonitor(QObject *parent = nullptr);
+    ~ProcessMonitor();
+
+    void handleRequest(const QJsonObject &request, QWebSocket *client);
+    void clientDisconnected(QWebSocket *client);
+    void reattachClient(QWebSocket *from, QWebSocket *to);
+
+private slots:
+    void scan();
+
+private:
+    struct Process
+    {
+        int pid = 0;
+        int ppid = 0;
+        quint64 startTime = 0; // Distinguishes a reused pid
+        QString name;
+        QString command;
+        QString user;
+        char state = '?';
+        int threads = 0;
+        qint64 rssKb = 0;
+        quint64 cpuTicks = 0;
+        double cpu = 0;        // Percent of one core since the last scan
+        quint64 seenScan = 0;
+    };
+
+    enum SortKey { SortCpu, SortMemory, SortPid, SortName };
+
+    struct Subscriber
+    {
+        QWebSocket *client = nullptr;
+        int intervalMs = 1000;
+        qint64 nextDue = 0;
+        SortKey sort = SortCpu;
+        bool descending = true;
+        int offset = 0;
+        int limit = 50;
+        QHash<int, QJsonObject> sent; // Rows on the page as last sent
+        QList<int> order;
+    };
+
+    void subscribe(const QJsonObject &request, QWebSocket *client);
+    void configure(Subscriber &subscriber, const QJsonObject &request);
+    void kill(const QJsonObject &request, QWebSocket *client);
+    void sendStats(QWebSocket *client);
+    void sendUnavailable(const QJsonObject &request, QWebSocket *client);
+    void publish(Subscriber &subscriber, const QJsonValue &id = QJsonValue(QJsonValue::Undefined));
+    void updateTimer();
+
+    bool scanProcesses();
+    bool readStat(Process &process, const char *text, bool fresh);
+    void readStaticFields(Process &process);
+    QString userName(uint uid);
+    QJsonObject row(const Process &process) const;
+
+    QTimer *m_timer;
+    QList<Subscriber> m_subscribers;
+    QElapsedTimer m_clock;
+
+    QHash<int, Process> m_processes;
+    QHash<uint, QString> m_users;
+    std::vector<const Process *> m_sorted;
+    ProcFile m_file; // Reopened per file; keeps its buffer between reads
+    quint64 m_scan = 0;
+    qint64 m_lastScanAt = -1;
+    long m_ticksPerSecond = 100;
+
+    // Scan cost, reported by process/stats
+    qint64 m_scanNs = 0;
+    qint64 m_lastScanNs = 0;
+    quint64 m_staticReads = 0;
+};
@@ -0,0 +1,149 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#include "procfile.h"
+#include <cstring>
+#include <utility>
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static const size_t InitialBufferSize = 4096;
+
+ProcFile::ProcFile(const QByteArray &path)
+{
+    open(path);
+}
+
+ProcFile::~ProcFile()
+{
+    close();
+}
+
+ProcFile::ProcFile(ProcFile &&other) noexcept
+    : m_fd(std::exchange(other.m_fd, -1))
+    , m_size(other.m_size)
+    , m_buffer(std::move(other.m_buffer))
+{
+}
+
+ProcFile &ProcFile::operator=(ProcFile &&other) noexcept
+{
+    if (this != &other) {
+        close();
+        m_fd = std::exchange(other.m_fd, -1);
+        m_size = other.m_size;
+        m_buffer = std::move(other.m_buffer);
+    }
+    return *this;
+}
+
+bool ProcFile::open(const QByteArray &path)
+{
+    close();
+#ifdef Q_OS_UNIX
+    m_fd = ::open(path.constData(), O_RDONLY | O_CLOEXEC);
+#else
+    Q_UNUSED(path);
+#endif
+    if (m_buffer.empty()) {
+        m_buffer.resize(InitialBufferSize);
+    }
+    return m_fd >= 0;
+}
+
+void ProcFile::close()
+{
+#ifdef Q_OS_UNIX
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+#endif
+    m_fd = -1;
+}
+
+const char *ProcFile::read()
+{
+#ifdef Q_OS_UNIX
+    if (m_fd < 0) {
+        return nullptr;
+    }
+
+    // /proc files are generated on read, so a short read means the whole
+    // file fit; a full buffer means it may have been cut off
+    for (;;) {
+        const ssize_t size = ::pread(m_fd, m_buffer.data(), m_buffer.size() - 1, 0);
+        if (size < 0) {
+            return nullptr;
+        }
+        if (size_t(size) < m_buffer.size() - 1) {
+            m_buffer[size] = '\0';
+            m_size = qsizetype(size);
+            return m_buffer.data();
+        }
+        m_buffer.resize(m_buffer.size() * 2);
+    }
+#else
+    return nullptr;
+#endif
+}
+
+const char *ProcFile::skipSpaces(const char *cursor)
+{
+    while (*cursor == ' ' || *cursor == '\t') {
+        ++cursor;
+    }
+    return cursor;
+}
+
+const char *ProcFile::skipFields(const char *cursor, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        cursor = skipSpaces(cursor);
+        while (*cursor && *cursor != ' ' && *cursor != '\t' && *cursor != '\n') {
+            ++cursor;
+        }
+    }
+    return cursor;
+}
+
+quint64 ProcFile::parseNumber(const char *&cursor)
+{
+    cursor = skipSpaces(cursor);
+    quint64 value = 0;
+    while (*cursor >= '0' && *cursor <= '9') {
+        value = value * 10 + quint64(*cursor - '0');
+        ++cursor;
+    }
+    return value;
+}
+
+qint64 ProcFile::parseSigned(const char *&cursor)
+{
+    cursor = skipSpaces(cursor);
+    const bool negative = *cursor == '-';
+    if (negative) {
+        ++cursor;
+    }
+    const qint64 value = qint64(parseNumber(cursor));
+    return negative ? -value : value;
+}
+
+const char *ProcFile::findLine(const char *text, const char *prefix)
+{
+    const size_t length = strlen(prefix);
+    for (const char *line = text; line && *line; line = nextLine(line)) {
+        if (strncmp(line, prefix, length) == 0) {
+            return line;
+        }
+    }
+    return nullptr;
+}
+
+const char *ProcFile::nextLine(const char *cursor)
+{
+    const char *end = strchr(cursor, '\n');
+    return end ? end + 1 : nullptr;
+}
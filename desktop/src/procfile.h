@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#pragma once
+
+#include <QByteArray>
+#include <QtGlobal>
+#include <vector>
+
+// A /proc or /sys file kept open between samples. Reading rewinds with
+// pread() into a buffer that is reused, so steady-state sampling makes no
+// syscalls besides the read and allocates nothing.
+class ProcFile
+{
+public:
+    ProcFile() = default;
+    explicit ProcFile(const QByteArray &path);
+    ~ProcFile();
+
+    ProcFile(ProcFile &&other) noexcept;
+    ProcFile &operator=(ProcFile &&other) noexcept;
+    ProcFile(const ProcFile &) = delete;
+    ProcFile &operator=(const ProcFile &) = delete;
+
+    bool open(const QByteArray &path);
+    void close();
+    bool isOpen() const { return m_fd >= 0; }
+
+    // Returns the current, null-terminated contents, valid until the next
+    // read, or nullptr when the file is gone (e.g. the process exited)
+    const char *read();
+    // Length of the last read, for files with embedded nulls
+    qsizetype size() const { return m_size; }
+
+    // Parsing helpers that walk a cursor through the text in place
+    static const char *skipSpaces(const char *cursor);
+    static const char *skipFields(const char *cursor, int count);
+    static quint64 parseNumber(const char *&cursor);
+    static qint64 parseSigned(const char *&cursor);
+    // Start of the line beginning with prefix, or nullptr
+    static const char *findLine(const char *text, const char *prefix);
+    static const char *nextLine(const char *cursor);
+
+private:
+    int m_fd = -1;
+    qsizetype m_size = 0;
+    std::vector<char> m_buffer;
+};
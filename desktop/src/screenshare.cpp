@@ -2,19 +2,457 @@
 // Copyright (C) 2026 Multi-Function PC Remote Contributors
 
 #include "screenshare.h"
+#include "damagemonitor.h"
+#include "capturebackend.h"
+#include "cursortracker.h"
+#include "stripeencoder.h"
+#include "windowtracker.h"
 #include <QScreen>
 #include <QGuiApplication>
 #include <QPixmap>
+#include <QPainter>
 #include <QBuffer>
+#include <QImageWriter>
 #include <QJsonDocument>
+#include <QJsonArray>
 #include <QWebSocket>
+#include <QThread>
+#include <QCursor>
+#include <QHash>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QtMath>
 #include <QDebug>
+#include <algorithm>
 
-ScreenShare::ScreenShare(QObject *parent)
+static const int WarmUpFrames = 3;
+
+// Time allowed for a burst of damage to settle before capturing
+static const int CoalesceDelayMs = 4;
+static const int DefaultMaxFps = 30;
+static const int DefaultPollingFps = 10;
+
+static const int StandardQuality = 75;
+static const int MotionQuality = 40;
+static const int RefineQuality = 90;
+
+// Refinement works on square tiles of output pixels; a tile is refined once
+// it has stayed unchanged for SettleMs
+static const int TileSize = 64;
+static const int SettleMs = 300;
+
+// Below this height splitting a frame costs more in headers than it saves
+static const int MinStripeHeight = 128;
+
+static const char FrameSuffix[] = "\"}";
+
+// Target name used for the whole virtual desktop
+static const QString VirtualDesktop = QStringLiteral("virtual");
+// Target names of single windows are this followed by the window id
+static const QString WindowPrefix = QStringLiteral("window:");
+
+namespace {
+
+// Change and quality state of each tile of a pipeline's output
+struct TileState
+{
+    QSize imageSize;
+    int columns = 0;
+    int rows = 0;
+    QVector<size_t> hashes;
+    QVector<qint64> changedAt;
+    QVector<bool> changed;   // In the latest capture
+    QVector<bool> refined;
+    QVector<size_t> bandHashes;
+};
+
+}
+
+struct ScreenShare::Pipeline
+{
+    QString target;
+    QByteArray messagePrefix;
+
+    // Owned per pipeline because captured images may point into backend
+    // memory that must stay untouched until this pipeline's frame is encoded
+    std::unique_ptr<CaptureBackend> capture;
+    qint64 lastCaptureUs = 0;
+    qint64 totalCaptureUs = 0;
+    quint64 captures = 0;
+
+    FrameBufferPool pool;
+    QBuffer jpegBuffer;
+    QImageWriter jpegWriter;
+    std::unique_ptr<StripeEncoder> stripeEncoder;
+    QByteArray stripedPrefix;
+    QByteArray updatePrefix;
+    QByteArray refinePrefix;
+    int lastStripes = 1;
+    qint64 lastEncodeUs = 0;
+    qint64 totalEncodeUs = 0;
+    quint64 encodes = 0;
+
+    // Only touched on the GUI thread: busy is set when a frame is handed to
+    // the encoder pool and cleared when it has been sent; dirty means the
+    // target changed since its last capture
+    bool busy = false;
+    bool dirty = true;
+    // The client needs a whole frame before it can take partial updates
+    bool fullFrame = true;
+    QRect globalRegion;
+    QSizeF outputScale = QSizeF(1.0, 1.0);
+    bool cursorVisible = false;
+
+    // Only touched by the encoder job, except for resets while idle
+    std::atomic<size_t> lastHash{0};
+
+    // Owned by whichever side currently holds busy: the most recently
+    // encoded frame and the tiles describing it, kept for refinement
+    TileState tiles;
+    FrameBufferRef lastFrame;
+
+    quint64 frames = 0;
+    quint64 droppedFrames = 0;
+    quint64 unchangedFrames = 0;
+    quint64 refinements = 0;
+    qint64 bytesSent = 0;
+    quint64 warmAllocations = 0;
+};
+
+static qsizetype base64Length(qsizetype size)
+{
+    return ((size + 2) / 3) * 4;
+}
+
+// QByteArray::toBase64 always returns a new array; this writes into
+// existing storage instead.
+static char *writeBase64(char *out, const char *in, qsizetype size)
+{
+    static const char alphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    const auto *src = reinterpret_cast<const uchar *>(in);
+    qsizetype i = 0;
+    for (; i + 2 < size; i += 3) {
+        const uint chunk = (uint(src[i]) << 16) | (uint(src[i + 1]) << 8) | src[i + 2];
+        *out++ = alphabet[(chunk >> 18) & 0x3f];
+        *out++ = alphabet[(chunk >> 12) & 0x3f];
+        *out++ = alphabet[(chunk >> 6) & 0x3f];
+        *out++ = alphabet[chunk & 0x3f];
+    }
+    if (i < size) {
+        uint chunk = uint(src[i]) << 16;
+        if (i + 1 < size)
+            chunk |= uint(src[i + 1]) << 8;
+        *out++ = alphabet[(chunk >> 18) & 0x3f];
+        *out++ = alphabet[(chunk >> 12) & 0x3f];
+        *out++ = (i + 1 < size) ? alphabet[(chunk >> 6) & 0x3f] : '=';
+        *out++ = '=';
+    }
+    return out;
+}
+
+static QByteArray jsonString(const QString &value)
+{
+    // Serialize through QJsonDocument to get correct escaping, then drop the brackets
+    const QByteArray array = QJsonDocument(QJsonArray{value}).toJson(QJsonDocument::Compact);
+    return array.mid(1, array.size() - 2);
+}
+
+static QString shapeKey(quint64 id)
+{
+    // Hex keeps all 64 bits, which a JSON number would not
+    return QString::number(id, 16);
+}
+
+static QRect virtualDesktopGeometry()
+{
+    QRect geometry;
+    for (QScreen *screen : QGuiApplication::screens()) {
+        geometry |= screen->geometry();
+    }
+    return geometry;
+}
+
+// The window a target name refers to, or 0 for screens
+static quint64 targetWindow(const QString &target)
+{
+    return target.startsWith(WindowPrefix) ? target.mid(WindowPrefix.size()).toULongLong() : 0;
+}
+
+static QScreen *findScreen(const QString &name)
+{
+    for (QScreen *screen : QGuiApplication::screens()) {
+        if (screen->name() == name) {
+            return screen;
+        }
+    }
+    return nullptr;
+}
+
+// Hashes every tile of the image and records which ones changed. Rows are
+// walked once, top to bottom, feeding each tile's slice into its hash.
+// Returns the number of tiles that changed.
+static int updateTiles(TileState &tiles, const QImage &image, qint64 now)
+{
+    if (tiles.imageSize != image.size()) {
+        tiles.imageSize = image.size();
+        tiles.columns = (image.width() + TileSize - 1) / TileSize;
+        tiles.rows = (image.height() + TileSize - 1) / TileSize;
+        const int count = tiles.columns * tiles.rows;
+        tiles.hashes.fill(0, count);
+        tiles.changedAt.fill(now, count);
+        tiles.changed.fill(false, count);
+        tiles.refined.fill(false, count);
+        tiles.bandHashes.resize(tiles.columns);
+    }
+
+    const int bytesPerPixel = image.depth() / 8;
+    int changed = 0;
+    for (int row = 0; row < tiles.rows; ++row) {
+        std::fill(tiles.bandHashes.begin(), tiles.bandHashes.end(), size_t(row));
+        const int lastLine = qMin(image.height(), (row + 1) * TileSize);
+        for (int y = row * TileSize; y < lastLine; ++y) {
+            const uchar *line = image.constScanLine(y);
+            for (int column = 0; column < tiles.columns; ++column) {
+                const int x = column * TileSize;
+                const int width = qMin(TileSize, image.width() - x);
+                tiles.bandHashes[column] = qHashBits(line + x * bytesPerPixel,
+                                                     size_t(width * bytesPerPixel),
+                                                     tiles.bandHashes[column]);
+            }
+        }
+
+        for (int column = 0; column < tiles.columns; ++column) {
+            const int index = row * tiles.columns + column;
+            tiles.changed[index] = tiles.hashes[index] != tiles.bandHashes[column];
+            if (tiles.changed[index]) {
+                tiles.hashes[index] = tiles.bandHashes[column];
+                tiles.changedAt[index] = now;
+                tiles.refined[index] = false;
+                ++changed;
+            }
+        }
+    }
+    return changed;
+}
+
+// Covers the tiles matching the predicate with rectangles in output pixels.
+// Each row's runs of matching tiles are joined with a run of the same
+// columns in the row above, so separate areas are never merged into one.
+template <typename Predicate>
+static QList<QRect> tileRects(const TileState &tiles, Predicate matches)
+{
+    QList<QRect> rects;
+    QList<qsizetype> open;   // Rects that end in the previous row
+    QList<qsizetype> next;
+    for (int row = 0; row < tiles.rows; ++row) {
+        next.clear();
+        for (int column = 0; column < tiles.columns; ++column) {
+            if (!matches(row * tiles.columns + column))
+                continue;
+            const int first = column;
+            while (column + 1 < tiles.columns && matches(row * tiles.columns + column + 1)) {
+                ++column;
+            }
+
+            const QRect run(first, row, column - first + 1, 1);
+            qsizetype extended = -1;
+            for (qsizetype index : std::as_const(open)) {
+                if (rects[index].left() == run.left() && rects[index].width() == run.width()) {
+                    rects[index].setBottom(row);
+                    extended = index;
+                    break;
+                }
+            }
+            if (extended < 0) {
+                extended = rects.size();
+                rects.append(run);
+            }
+            next.append(extended);
+        }
+        std::swap(open, next);
+    }
+
+    const QRect bounds(QPoint(0, 0), tiles.imageSize);
+    for (QRect &rect : rects) {
+        rect = QRect(rect.x() * TileSize, rect.y() * TileSize,
+                     rect.width() * TileSize, rect.height() * TileSize) & bounds;
+    }
+    return rects;
+}
+
+// Areas of tiles that have settled but are still at motion quality;
+// pending is set if other tiles still wait to settle
+static QList<QRect> settledRects(const TileState &tiles, qint64 now, bool *pending)
+{
+    return tileRects(tiles, [&tiles, now, pending](int index) {
+        if (tiles.refined[index])
+            return false;
+        if (now - tiles.changedAt[index] < SettleMs) {
+            *pending = true;
+            return false;
+        }
+        return true;
+    });
+}
+
+static void markRefined(TileState &tiles, const QRect &region)
+{
+    for (int row = region.top() / TileSize; row <= region.bottom() / TileSize; ++row) {
+        for (int column = region.left() / TileSize; column <= region.right() / TileSize; ++column) {
+            tiles.refined[row * tiles.columns + column] = true;
+        }
+    }
+}
+
+bool ScreenShare::encodeImage(Pipeline &pipeline, const QImage &image, QByteArray &encoded, int quality)
+{
+    const qsizetype capacity = encoded.capacity();
+
+    encoded.resize(0);
+    pipeline.jpegWriter.setQuality(quality);
+    pipeline.jpegBuffer.setBuffer(&encoded);
+    pipeline.jpegBuffer.open(QIODevice::WriteOnly);
+    const bool ok = pipeline.jpegWriter.write(image);
+    pipeline.jpegBuffer.close();
+
+    if (encoded.capacity() != capacity) {
+        pipeline.pool.noteAllocation();
+    }
+    if (!ok) {
+        qWarning() << "Failed to encode frame:" << pipeline.jpegWriter.errorString();
+    }
+    return ok;
+}
+
+void ScreenShare::buildFrameMessage(Pipeline &pipeline, FrameBuffer &frame, const QByteArray &prefix)
+{
+    const qsizetype suffixLength = sizeof(FrameSuffix) - 1;
+    const qsizetype length = prefix.size() + base64Length(frame.encoded.size()) + suffixLength;
+
+    pipeline.pool.ensureCapacity(frame.message, length);
+    frame.message.resize(length);
+
+    char *out = frame.message.data();
+    memcpy(out, prefix.constData(), prefix.size());
+    out = writeBase64(out + prefix.size(), frame.encoded.constData(), frame.encoded.size());
+    memcpy(out, FrameSuffix, suffixLength);
+}
+
+// Writes {"type":"screen","action":"frame","screen":...,"width":W,"height":H,
+// "stripes":[{"y":0,"data":"..."},...]}, base64 encoding every stripe straight
+// into its place in the message
+void ScreenShare::buildStripedMessage(Pipeline &pipeline, FrameBuffer &frame, int stripeHeight)
+{
+    const int count = StripeEncoder::stripeCount(frame.image.height(), stripeHeight);
+
+    char header[64];
+    const int headerLength = qsnprintf(header, sizeof(header), "\"width\":%d,\"height\":%d,\"stripes\":[",
+                                       frame.image.width(), frame.image.height());
+
+    char stripeHeader[32];
+    qsizetype length = pipeline.stripedPrefix.size() + headerLength + 2;
+    for (int i = 0; i < count; ++i) {
+        length += qsnprintf(stripeHeader, sizeof(stripeHeader), "{\"y\":%d,\"data\":\"", i * stripeHeight);
+        length += base64Length(frame.stripes[i].size()) + 2 + (i > 0 ? 1 : 0);
+    }
+
+    pipeline.pool.ensureCapacity(frame.message, length);
+    frame.message.resize(length);
+
+    char *out = frame.message.data();
+    memcpy(out, pipeline.stripedPrefix.constData(), pipeline.stripedPrefix.size());
+    out += pipeline.stripedPrefix.size();
+    memcpy(out, header, headerLength);
+    out += headerLength;
+    for (int i = 0; i < count; ++i) {
+        if (i > 0) {
+            *out++ = ',';
+        }
+        const int stripeHeaderLength = qsnprintf(stripeHeader, sizeof(stripeHeader),
+                                                 "{\"y\":%d,\"data\":\"", i * stripeHeight);
+        memcpy(out, stripeHeader, stripeHeaderLength);
+        out = writeBase64(out + stripeHeaderLength, frame.stripes[i].constData(), frame.stripes[i].size());
+        *out++ = '"';
+        *out++ = '}';
+    }
+    *out++ = ']';
+    *out++ = '}';
+}
+
+// Encodes each rectangle of the image on its own and writes one message
+// per rectangle, {...prefix,"x":X,"y":Y,"width":W,"height":H,"data":"..."}
+bool ScreenShare::encodeRects(Pipeline &pipeline, FrameBuffer &frame, const QImage &image,
+                              const QList<QRect> &rects, const QByteArray &prefix, int quality)
+{
+    if (frame.rectMessages.size() < rects.size()) {
+        frame.rectMessages.resize(rects.size());
+        pipeline.pool.noteAllocation();
+    }
+
+    const int bytesPerPixel = image.depth() / 8;
+    const qsizetype suffixLength = sizeof(FrameSuffix) - 1;
+    char header[96];
+    for (qsizetype i = 0; i < rects.size(); ++i) {
+        // Encode straight out of the image, without copying the area
+        const QRect &rect = rects[i];
+        const QImage view(image.constBits() + rect.y() * image.bytesPerLine() + rect.x() * bytesPerPixel,
+                          rect.width(), rect.height(), image.bytesPerLine(), image.format());
+        if (!encodeImage(pipeline, view, frame.encoded, quality)) {
+            return false;
+        }
+
+        const int headerLength = qsnprintf(header, sizeof(header),
+                                           "\"x\":%d,\"y\":%d,\"width\":%d,\"height\":%d,\"data\":\"",
+                                           rect.x(), rect.y(), rect.width(), rect.height());
+        const qsizetype length = prefix.size() + headerLength + base64Length(frame.encoded.size()) + suffixLength;
+
+        QByteArray &message = frame.rectMessages[i];
+        pipeline.pool.ensureCapacity(message, length);
+        message.resize(length);
+
+        char *out = message.data();
+        memcpy(out, prefix.constData(), prefix.size());
+        memcpy(out + prefix.size(), header, headerLength);
+        out = writeBase64(out + prefix.size() + headerLength, frame.encoded.constData(), frame.encoded.size());
+        memcpy(out, FrameSuffix, suffixLength);
+    }
+    return true;
+}
+
+ScreenShare::ScreenShare(WindowTracker *windows, QObject *parent)
     : QObject(parent)
     , m_captureTimer(new QTimer(this))
+    , m_damageMonitor(new DamageMonitor(this))
+    , m_cursorTracker(new CursorTracker(this))
+    , m_refineTimer(new QTimer(this))
+    , m_windows(windows)
 {
+    m_stripePool.setMaxThreadCount(QThread::idealThreadCount());
+    m_clock.start();
+    m_refineTimer->setSingleShot(true);
+    connect(m_refineTimer, &QTimer::timeout, this, &ScreenShare::refineSettledRegions);
+
     connect(m_captureTimer, &QTimer::timeout, this, &ScreenShare::captureAndSendFrame);
+    connect(m_damageMonitor, &DamageMonitor::damaged, this, &ScreenShare::onDamaged);
+    m_captureTimer->setSingleShot(m_damageMonitor->isEventDriven());
+    connect(m_cursorTracker, &CursorTracker::moved, this, &ScreenShare::sendCursorPosition);
+    connect(m_cursorTracker, &CursorTracker::shapeChanged, this, &ScreenShare::onCursorShapeChanged);
+    if (m_windows) {
+        connect(m_windows, &WindowTracker::geometryChanged, this, &ScreenShare::onWindowGeometryChanged);
+        connect(m_windows, &WindowTracker::windowClosed, this, &ScreenShare::onWindowClosed);
+    }
+
+    if (QScreen *primary = QGuiApplication::primaryScreen()) {
+        m_pipelines.append(createPipeline(primary->name()));
+    }
+}
+
+ScreenShare::~ScreenShare()
+{
+    // Encoder jobs reference the pipelines; let them finish first
+    m_encodePool.waitForDone();
 }
 
 void ScreenShare::handleRequest(const QJsonObject &request, QWebSocket *client)
@@ -22,23 +460,108 @@ void ScreenShare::handleRequest(const QJsonObject &request, QWebSocket *client)
     QString action = request["action"].toString();
     
     if (action == "start") {
-        startStreaming(client);
+        startStreaming(client, request);
     } else if (action == "stop") {
         stopStreaming();
+        QJsonObject response;
+        response["type"] = "screen";
+        response["action"] = "stop";
+        response["id"] = request["id"];
+        response["status"] = "stopped";
+        client->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
+    } else if (action == "list") {
+        listScreens(request, client);
+    } else if (action == "select") {
+        selectScreens(request, client);
+    } else if (action == "viewport") {
+        setViewport(request, client);
+    } else if (action == "cursor_shape") {
+        // Lets a client recover a shape it dropped from its cache
+        sendCursorShape(client, request["shape"].toString().toULongLong(nullptr, 16));
+    } else if (action == "stats") {
+        sendStats(client);
+    }
+}
+
+void ScreenShare::clientDisconnected(QWebSocket *client)
+{
+    if (client == m_streamingClient) {
+        stopStreaming();
+    }
+}
+
+void ScreenShare::reattachClient(QWebSocket *from, QWebSocket *to)
+{
+    if (from != m_streamingClient) {
+        return;
+    }
+
+    // Whatever was in flight on the old connection may be lost, so the
+    // stream restarts with full frames and cursor shapes
+    m_streamingClient = to;
+    m_sentCursorShapes.clear();
+    for (const auto &pipeline : m_pipelines) {
+        pipeline->cursorVisible = false;
     }
+    markAllDirty();
+    m_firstFrameTimer.start();
+    m_resuming = true;
+    m_sinceCapture.invalidate();
+    scheduleCapture();
 }
 
-void ScreenShare::startStreaming(QWebSocket *client)
+bool ScreenShare::isStreaming() const
+{
+    // A client waiting to resume its session keeps the stream but is not sent to
+    return m_streamingClient && m_streamingClient->isValid();
+}
+
+void ScreenShare::startStreaming(QWebSocket *client, const QJsonObject &request)
 {
     if (m_streamingClient) {
         stopStreaming();
     }
     
     m_streamingClient = client;
-    m_captureTimer->start(100); // 10 FPS
+    for (const auto &pipeline : m_pipelines) {
+        pipeline->frames = 0;
+        pipeline->droppedFrames = 0;
+        pipeline->unchangedFrames = 0;
+        pipeline->refinements = 0;
+        pipeline->bytesSent = 0;
+        pipeline->warmAllocations = pipeline->pool.allocations();
+        pipeline->cursorVisible = false;
+    }
+    markAllDirty();
+    m_sentCursorShapes.clear();
+    m_cursorTracker->start();
+    m_firstFrameTimer.start();
+    m_resuming = false;
+
+    m_progressive = request["progressive"].toBool();
+
+    // "stripes": true uses one stripe per core; a number asks for that many
+    const QJsonValue stripes = request["stripes"];
+    m_stripeCount = stripes.isBool()
+        ? (stripes.toBool() ? QThread::idealThreadCount() : 1)
+        : qBound(1, stripes.toInt(1), 64);
+
+    const bool eventDriven = m_damageMonitor->isEventDriven();
+    const int maxFps = qBound(1, request["maxFps"].toInt(eventDriven ? DefaultMaxFps : DefaultPollingFps), 60);
+    m_minFrameInterval = 1000 / maxFps;
+
+    if (eventDriven) {
+        // Send the first frame right away; after that only damage triggers captures
+        m_sinceCapture.invalidate();
+        m_captureTimer->start(0);
+    } else {
+        m_captureTimer->start(m_minFrameInterval);
+    }
     
     QJsonObject response;
     response["type"] = "screen";
+    response["action"] = "start";
+    response["id"] = request["id"];
     response["status"] = "streaming";
     client->sendTextMessage(QJsonDocument(response).toJson());
     
@@ -48,33 +571,682 @@ void ScreenShare::startStreaming(QWebSocket *client)
 void ScreenShare::stopStreaming()
 {
     m_captureTimer->stop();
+    m_refineTimer->stop();
+    m_cursorTracker->stop();
     m_streamingClient = nullptr;
     qDebug() << "Screen sharing stopped";
 }
 
+void ScreenShare::onDamaged(const QRect &rect)
+{
+    if (!isStreaming()) {
+        return;
+    }
+
+    bool affected = false;
+    for (const auto &pipeline : m_pipelines) {
+        if (pipeline->globalRegion.isNull() || pipeline->globalRegion.intersects(rect)) {
+            pipeline->dirty = true;
+            affected = true;
+        }
+    }
+    if (affected) {
+        scheduleCapture();
+    }
+}
+
+void ScreenShare::sendCursorPosition(const QPoint &position)
+{
+    if (!isStreaming()) {
+        return;
+    }
+
+    // Positions are in the pixel coordinates of each target's frames
+    for (const auto &pipeline : m_pipelines) {
+        const bool visible = pipeline->globalRegion.contains(position);
+        if (!visible && !pipeline->cursorVisible) {
+            continue;
+        }
+        pipeline->cursorVisible = visible;
+
+        const QPoint local = position - pipeline->globalRegion.topLeft();
+        QJsonObject message;
+        message["type"] = "screen";
+        message["action"] = "cursor";
+        message["screen"] = pipeline->target;
+        message["visible"] = visible;
+        message["x"] = qRound(local.x() * pipeline->outputScale.width());
+        message["y"] = qRound(local.y() * pipeline->outputScale.height());
+        message["scale"] = pipeline->outputScale.width();
+        if (m_cursorTracker->shapeId()) {
+            message["shape"] = shapeKey(m_cursorTracker->shapeId());
+        }
+        m_streamingClient->sendTextMessage(QJsonDocument(message).toJson(QJsonDocument::Compact));
+    }
+}
+
+void ScreenShare::onCursorShapeChanged(quint64 id)
+{
+    if (!isStreaming()) {
+        return;
+    }
+
+    if (!m_sentCursorShapes.contains(id)) {
+        sendCursorShape(m_streamingClient, id);
+    }
+
+    // Tell the client about the new shape even if the pointer is not moving
+    for (const auto &pipeline : m_pipelines) {
+        pipeline->cursorVisible = true;
+    }
+    sendCursorPosition(QCursor::pos());
+}
+
+void ScreenShare::onWindowGeometryChanged(quint64 window)
+{
+    // Damage covers what is drawn, not a window that moved or resized
+    const QString target = WindowPrefix + QString::number(window);
+    for (const auto &pipeline : m_pipelines) {
+        if (pipeline->target == target) {
+            pipeline->dirty = true;
+            pipeline->lastHash = 0;
+            scheduleCapture();
+        }
+    }
+}
+
+void ScreenShare::onWindowClosed(quint64 window)
+{
+    const QString target = WindowPrefix + QString::number(window);
+    const qsizetype removed = m_pipelines.removeIf([&target](const std::shared_ptr<Pipeline> &pipeline) {
+        return pipeline->target == target;
+    });
+    if (removed == 0 || !isStreaming()) {
+        return;
+    }
+
+    // Nothing is streamed until the client selects something else
+    QJsonObject message;
+    message["type"] = "screen";
+    message["action"] = "window_closed";
+    message["screen"] = target;
+    message["window"] = double(window);
+    m_streamingClient->sendTextMessage(QJsonDocument(message).toJson(QJsonDocument::Compact));
+}
+
+void ScreenShare::sendCursorShape(QWebSocket *client, quint64 id)
+{
+    const CursorTracker::Shape *shape = m_cursorTracker->shape(id);
+    if (!shape) {
+        return;
+    }
+
+    // Shapes are scaled like the frame they are drawn on; clients do that
+    // using the scale of the target the pointer is in
+    QJsonObject message;
+    message["type"] = "screen";
+    message["action"] = "cursor_shape";
+    message["shape"] = shapeKey(id);
+    message["width"] = shape->image.width();
+    message["height"] = shape->image.height();
+    message["hotX"] = shape->hotSpot.x();
+    message["hotY"] = shape->hotSpot.y();
+    message["devicePixelRatio"] = shape->image.devicePixelRatio();
+    message["data"] = QString::fromLatin1(shape->png.toBase64());
+    client->sendTextMessage(QJsonDocument(message).toJson(QJsonDocument::Compact));
+
+    if (client == m_streamingClient) {
+        m_sentCursorShapes.insert(id);
+    }
+}
+
+void ScreenShare::scheduleCapture()
+{
+    // Polling mode captures on its own interval
+    if (!isStreaming() || !m_damageMonitor->isEventDriven() || m_captureTimer->isActive()) {
+        return;
+    }
+
+    // Wait a moment so a burst of damage is captured once, but never run
+    // faster than the frame rate limit
+    const qint64 sinceCapture = m_sinceCapture.isValid() ? m_sinceCapture.elapsed() : m_minFrameInterval;
+    m_captureTimer->start(int(qMax<qint64>(CoalesceDelayMs, m_minFrameInterval - sinceCapture)));
+}
+
+void ScreenShare::markAllDirty()
+{
+    for (const auto &pipeline : m_pipelines) {
+        pipeline->dirty = true;
+        pipeline->lastHash = 0;
+        pipeline->fullFrame = true;
+        if (!pipeline->busy) {
+            pipeline->tiles = TileState();
+        }
+    }
+}
+
+void ScreenShare::listScreens(const QJsonObject &request, QWebSocket *client)
+{
+    QScreen *primary = QGuiApplication::primaryScreen();
+
+    QJsonArray screens;
+    const QList<QScreen *> available = QGuiApplication::screens();
+    for (int i = 0; i < available.size(); ++i) {
+        QScreen *screen = available[i];
+        const QRect geometry = screen->geometry();
+
+        QJsonObject info;
+        info["index"] = i;
+        info["name"] = screen->name();
+        info["x"] = geometry.x();
+        info["y"] = geometry.y();
+        info["width"] = geometry.width();
+        info["height"] = geometry.height();
+        info["devicePixelRatio"] = screen->devicePixelRatio();
+        info["primary"] = screen == primary;
+        screens.append(info);
+    }
+
+    const QRect desktop = virtualDesktopGeometry();
+    QJsonObject virtualDesktop;
+    virtualDesktop["x"] = desktop.x();
+    virtualDesktop["y"] = desktop.y();
+    virtualDesktop["width"] = desktop.width();
+    virtualDesktop["height"] = desktop.height();
+
+    QJsonArray selected;
+    for (const auto &pipeline : m_pipelines) {
+        selected.append(pipeline->target);
+    }
+
+    QJsonObject response;
+    response["type"] = "screen";
+    response["action"] = "list";
+    response["id"] = request["id"];
+    response["screens"] = screens;
+    response["virtual"] = virtualDesktop;
+    response["selected"] = selected;
+    client->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
+}
+
+void ScreenShare::selectScreens(const QJsonObject &request, QWebSocket *client)
+{
+    QJsonObject response;
+    response["type"] = "screen";
+    response["action"] = "select";
+    response["id"] = request["id"];
+
+    // "screens" is a screen index or name, an array of them, "all" for every
+    // screen separately, or "virtual" for the whole desktop as one image.
+    // "window" instead streams one window, by the id window/list reports.
+    const QList<QScreen *> available = QGuiApplication::screens();
+    const QJsonValue selection = request["screens"];
+
+    QStringList targets;
+    auto addScreen = [&](const QJsonValue &value) {
+        if (value.isDouble()) {
+            const int index = value.toInt(-1);
+            if (index < 0 || index >= available.size())
+                return false;
+            targets.append(available[index]->name());
+            return true;
+        }
+        if (!findScreen(value.toString()))
+            return false;
+        targets.append(value.toString());
+        return true;
+    };
+
+    const bool window = request.contains("window");
+    bool valid = true;
+    if (window) {
+        const quint64 id = quint64(request["window"].toInteger());
+        valid = m_windows && m_windows->contains(id);
+        targets.append(WindowPrefix + QString::number(id));
+    } else if (selection.toString() == VirtualDesktop) {
+        targets.append(VirtualDesktop);
+    } else if (selection.toString() == "all") {
+        for (QScreen *screen : available) {
+            targets.append(screen->name());
+        }
+    } else if (selection.isArray()) {
+        for (const QJsonValue &value : selection.toArray()) {
+            valid = valid && addScreen(value);
+        }
+    } else {
+        valid = addScreen(selection);
+    }
+    targets.removeDuplicates();
+
+    if (!valid || targets.isEmpty()) {
+        response["status"] = "error";
+        response["message"] = window ? "Unknown window" : "Unknown screen";
+        client->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
+        return;
+    }
+
+    // Keep existing pipelines, and their warm buffers, for targets still selected
+    QList<std::shared_ptr<Pipeline>> pipelines;
+    for (const QString &target : targets) {
+        std::shared_ptr<Pipeline> pipeline;
+        for (const auto &existing : m_pipelines) {
+            if (existing->target == target) {
+                pipeline = existing;
+                break;
+            }
+        }
+        pipelines.append(pipeline ? pipeline : createPipeline(target));
+    }
+    m_pipelines = pipelines;
+    markAllDirty();
+    scheduleCapture();
+
+    response["status"] = "success";
+    response["selected"] = QJsonArray::fromStringList(targets);
+    client->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
+}
+
+void ScreenShare::setViewport(const QJsonObject &request, QWebSocket *client)
+{
+    QJsonObject response;
+    response["type"] = "screen";
+    response["action"] = "viewport";
+    response["id"] = request["id"];
+
+    const QRect requested(request["x"].toInt(), request["y"].toInt(),
+                          request["width"].toInt(), request["height"].toInt());
+
+    // The viewport is relative to each selected target; an empty rectangle
+    // resets to the whole target. One that misses every target would only
+    // stop the stream, so it is refused.
+    const QRect viewport = requested.isEmpty() ? QRect() : requested.normalized();
+    if (!viewport.isNull()) {
+        bool visible = false;
+        for (const auto &pipeline : std::as_const(m_pipelines)) {
+            const QRect bounds(QPoint(0, 0), targetGeometry(pipeline->target).size());
+            visible = visible || bounds.intersects(viewport);
+        }
+        if (!visible) {
+            response["status"] = "error";
+            response["message"] = "Viewport is outside the selected screens";
+            client->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
+            return;
+        }
+    }
+    m_viewport = viewport;
+
+    const int outputWidth = request["outputWidth"].toInt();
+    const int outputHeight = request["outputHeight"].toInt();
+    if (outputWidth > 0 && outputHeight > 0) {
+        m_outputSize = QSize(outputWidth, outputHeight);
+    }
+    markAllDirty();
+    scheduleCapture();
+
+    response["status"] = "success";
+    response["x"] = m_viewport.x();
+    response["y"] = m_viewport.y();
+    response["width"] = m_viewport.width();
+    response["height"] = m_viewport.height();
+    response["outputWidth"] = m_outputSize.width();
+    response["outputHeight"] = m_outputSize.height();
+    client->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
+}
+
+void ScreenShare::sendStats(QWebSocket *client)
+{
+    QJsonArray pipelines;
+    for (const auto &pipeline : m_pipelines) {
+        const quint64 steadyFrames = pipeline->frames > WarmUpFrames
+            ? pipeline->frames - WarmUpFrames : 0;
+
+        QJsonObject stats;
+        stats["target"] = pipeline->target;
+        stats["captureBackend"] = pipeline->capture->name();
+        stats["lastCaptureUs"] = pipeline->lastCaptureUs;
+        stats["averageCaptureUs"] = pipeline->captures
+            ? pipeline->totalCaptureUs / qint64(pipeline->captures) : 0;
+        stats["frames"] = qint64(pipeline->frames);
+        stats["droppedFrames"] = qint64(pipeline->droppedFrames);
+        stats["unchangedFrames"] = qint64(pipeline->unchangedFrames);
+        stats["refinements"] = qint64(pipeline->refinements);
+        stats["stripes"] = pipeline->lastStripes;
+        stats["lastEncodeUs"] = pipeline->lastEncodeUs;
+        stats["averageEncodeUs"] = pipeline->encodes
+            ? pipeline->totalEncodeUs / qint64(pipeline->encodes) : 0;
+        stats["bytesSent"] = pipeline->bytesSent;
+        stats["bufferAllocations"] = qint64(pipeline->pool.allocations());
+        stats["steadyStateFrames"] = qint64(steadyFrames);
+        // Growth of pooled buffers only; Qt and the socket allocate on their own
+        stats["steadyStateBufferGrowth"] = qint64(pipeline->pool.allocations() - pipeline->warmAllocations);
+        stats["buffersInFlight"] = pipeline->pool.inFlight();
+        pipelines.append(stats);
+    }
+
+    QJsonObject data;
+    data["scheduling"] = m_damageMonitor->isEventDriven() ? "damage" : "polling";
+    data["progressive"] = m_progressive;
+    data["encoderThreads"] = m_encodePool.maxThreadCount();
+    data["stripeThreads"] = m_stripePool.maxThreadCount();
+    data["requestedStripes"] = m_stripeCount;
+    data["pipelines"] = pipelines;
+    data["startToFirstFrameMs"] = m_startToFrameMs;
+    data["resumeToFirstFrameMs"] = m_resumeToFrameMs;
+
+    QJsonObject response;
+    response["type"] = "screen";
+    response["action"] = "stats";
+    response["data"] = data;
+    client->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
+}
+
+std::shared_ptr<ScreenShare::Pipeline> ScreenShare::createPipeline(const QString &target)
+{
+    auto pipeline = std::make_shared<Pipeline>();
+    pipeline->target = target;
+    pipeline->capture = CaptureBackend::create();
+    pipeline->messagePrefix = "{\"type\":\"screen\",\"action\":\"frame\",\"screen\":"
+        + jsonString(target) + ",\"data\":\"";
+    pipeline->stripedPrefix = "{\"type\":\"screen\",\"action\":\"frame\",\"screen\":"
+        + jsonString(target) + ",";
+    pipeline->updatePrefix = "{\"type\":\"screen\",\"action\":\"update\",\"screen\":"
+        + jsonString(target) + ",";
+    pipeline->refinePrefix = "{\"type\":\"screen\",\"action\":\"refine\",\"screen\":"
+        + jsonString(target) + ",";
+    pipeline->stripeEncoder = std::make_unique<StripeEncoder>(&m_stripePool);
+
+    // The writer and its device live as long as the pipeline so the JPEG
+    // handler is created once rather than per frame
+    pipeline->jpegWriter.setDevice(&pipeline->jpegBuffer);
+    pipeline->jpegWriter.setFormat("JPEG");
+    return pipeline;
+}
+
 void ScreenShare::captureAndSendFrame()
 {
-    if (!m_streamingClient) {
+    if (!isStreaming()) {
         return;
     }
-    
-    QScreen *screen = QGuiApplication::primaryScreen();
-    if (!screen) {
+
+    m_sinceCapture.start();
+    const bool eventDriven = m_damageMonitor->isEventDriven();
+    for (const auto &pipeline : m_pipelines) {
+        if (!eventDriven || pipeline->dirty) {
+            captureTarget(pipeline);
+        }
+    }
+}
+
+QRect ScreenShare::targetGeometry(const QString &target) const
+{
+    if (const quint64 window = targetWindow(target)) {
+        // Null while the window is minimized or once it is gone
+        return m_windows->geometry(window);
+    }
+    if (target == VirtualDesktop) {
+        return virtualDesktopGeometry();
+    }
+    if (QScreen *screen = findScreen(target)) {
+        return screen->geometry();
+    }
+    return QRect();
+}
+
+void ScreenShare::captureTarget(const std::shared_ptr<Pipeline> &pipeline)
+{
+    if (pipeline->busy) {
+        // The previous frame is still encoding; it stays dirty and is
+        // captured again once the encoder is done
+        ++pipeline->droppedFrames;
         return;
     }
-    
-    QPixmap screenshot = screen->grabWindow(0);
-    screenshot = screenshot.scaled(1280, 720, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-    
-    QByteArray byteArray;
-    QBuffer buffer(&byteArray);
-    buffer.open(QIODevice::WriteOnly);
-    screenshot.save(&buffer, "JPEG", 75);
-    
-    QJsonObject frame;
-    frame["type"] = "screen";
-    frame["action"] = "frame";
-    frame["data"] = QString::fromLatin1(byteArray.toBase64());
-    
-    m_streamingClient->sendTextMessage(QJsonDocument(frame).toJson());
+    pipeline->dirty = false;
+
+    const quint64 window = targetWindow(pipeline->target);
+    const QRect geometry = targetGeometry(pipeline->target);
+    QRect region(QPoint(0, 0), geometry.size());
+    if (!m_viewport.isNull()) {
+        region &= m_viewport;
+    }
+    if (region.isEmpty()) {
+        return;
+    }
+    pipeline->globalRegion = region.translated(geometry.topLeft());
+
+    FrameBufferRef frame = pipeline->pool.acquire();
+    if (!frame) {
+        ++pipeline->droppedFrames;
+        return;
+    }
+
+    // Capture backends may only be used on the GUI thread. Only the region
+    // is read back, so capture cost follows its area.
+    QElapsedTimer captureTimer;
+    captureTimer.start();
+    const QList<CapturedImage> sources = window
+        ? pipeline->capture->grabWindow(window, geometry, region)
+        : pipeline->capture->grab(pipeline->globalRegion);
+    pipeline->lastCaptureUs = captureTimer.nsecsElapsed() / 1000;
+    pipeline->totalCaptureUs += pipeline->lastCaptureUs;
+    ++pipeline->captures;
+
+    qreal devicePixelRatio = 1.0;
+    for (const CapturedImage &source : sources) {
+        devicePixelRatio = qMax(devicePixelRatio, source.image.devicePixelRatio());
+    }
+    if (sources.isEmpty()) {
+        return;
+    }
+
+    QSize targetSize(qCeil(region.width() * devicePixelRatio),
+                     qCeil(region.height() * devicePixelRatio));
+    if (targetSize.width() > m_outputSize.width() || targetSize.height() > m_outputSize.height()) {
+        targetSize.scale(m_outputSize, Qt::KeepAspectRatio);
+    }
+    pipeline->outputScale = QSizeF(qreal(targetSize.width()) / region.width(),
+                                   qreal(targetSize.height()) / region.height());
+
+    pipeline->busy = true;
+    const bool fullFrame = pipeline->fullFrame;
+    pipeline->fullFrame = false;
+    const QSize regionSize = region.size();
+    const bool detectUnchanged = !m_damageMonitor->isEventDriven();
+    const bool progressive = m_progressive;
+    const qint64 now = m_clock.elapsed();
+    const int stripeCount = qMin(m_stripeCount, targetSize.height() / MinStripeHeight);
+    m_encodePool.start([this, pipeline, frame, sources, regionSize, targetSize,
+                        detectUnchanged, progressive, fullFrame, now, stripeCount]() {
+        // Compose, scale and encode off the GUI thread
+        pipeline->pool.ensureImage(*frame, targetSize, QImage::Format_RGB32);
+        // Gaps between screens, or parts of the region off the screen or
+        // outside the window, stay black
+        if (sources.size() > 1 || sources.first().target != QRect(QPoint(0, 0), regionSize)) {
+            frame->image.fill(Qt::black);
+        }
+        {
+            QPainter painter(&frame->image);
+            painter.setRenderHint(QPainter::SmoothPixmapTransform,
+                                  sources.first().image.size() != targetSize);
+            painter.scale(qreal(targetSize.width()) / regionSize.width(),
+                          qreal(targetSize.height()) / regionSize.height());
+            for (const CapturedImage &source : sources) {
+                painter.drawImage(QRectF(source.target), source.image);
+            }
+        }
+
+        // Skip encoding frames that did not change. Progressive mode needs
+        // per-tile state anyway and sends only the tiles that changed;
+        // otherwise this only matters when polling.
+        bool unchanged = false;
+        QList<QRect> updateRects;
+        if (progressive) {
+            TileState &tiles = pipeline->tiles;
+            const int changed = updateTiles(tiles, frame->image, now);
+            unchanged = changed == 0 && !fullFrame;
+            if (fullFrame || changed == tiles.changed.size()) {
+                // A whole frame at motion quality replaces refined tiles
+                // on the client too; the ones that did not change count as
+                // settled and are refined again right away
+                tiles.refined.fill(false);
+            } else if (changed > 0) {
+                updateRects = tileRects(tiles, [&tiles](int index) { return tiles.changed[index]; });
+            }
+        } else if (detectUnchanged) {
+            const size_t hash = qHashBits(frame->image.constBits(), size_t(frame->image.sizeInBytes()));
+            unchanged = pipeline->lastHash.exchange(hash) == hash;
+        }
+
+        const int quality = progressive ? MotionQuality : StandardQuality;
+        bool encoded = false;
+        int stripes = 1;
+        qint64 encodeUs = -1;
+        if (!unchanged) {
+            QElapsedTimer encodeTimer;
+            encodeTimer.start();
+
+            if (!updateRects.isEmpty()) {
+                encoded = encodeRects(*pipeline, *frame, frame->image, updateRects,
+                                      pipeline->updatePrefix, quality);
+            } else if (stripeCount > 1) {
+                const int stripeHeight = StripeEncoder::stripeHeight(targetSize.height(), stripeCount);
+                encoded = pipeline->stripeEncoder->encode(frame->image, stripeHeight, quality,
+                                                          frame->stripes, pipeline->pool);
+                if (encoded) {
+                    buildStripedMessage(*pipeline, *frame, stripeHeight);
+                    stripes = StripeEncoder::stripeCount(targetSize.height(), stripeHeight);
+                }
+            } else {
+                encoded = encodeImage(*pipeline, frame->image, frame->encoded, quality);
+                if (encoded) {
+                    buildFrameMessage(*pipeline, *frame, pipeline->messagePrefix);
+                }
+            }
+
+            encodeUs = encodeTimer.nsecsElapsed() / 1000;
+        }
+        if (encoded && progressive) {
+            pipeline->lastFrame = frame;
+        }
+
+        const int rectCount = int(updateRects.size());
+        QMetaObject::invokeMethod(this, [this, pipeline, frame, encoded, unchanged, progressive,
+                                         stripes, encodeUs, rectCount]() {
+            pipeline->busy = false;
+            if (encodeUs >= 0) {
+                pipeline->lastEncodeUs = encodeUs;
+                pipeline->totalEncodeUs += encodeUs;
+                pipeline->lastStripes = stripes;
+                ++pipeline->encodes;
+            }
+            if (unchanged) {
+                ++pipeline->unchangedFrames;
+            }
+            if (encoded) {
+                sendEncodedFrame(pipeline, frame, rectCount);
+                if (progressive && !m_refineTimer->isActive()) {
+                    m_refineTimer->start(SettleMs);
+                }
+            } else if (progressive && !unchanged) {
+                // The tiles were recorded as sent; make the client start over
+                pipeline->fullFrame = true;
+            }
+            if (pipeline->dirty) {
+                scheduleCapture();
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void ScreenShare::sendEncodedFrame(const std::shared_ptr<Pipeline> &pipeline, const FrameBufferRef &frame,
+                                   int rectCount)
+{
+    // The selection or the client may have changed while the frame was encoding
+    if (!isStreaming() || !m_pipelines.contains(pipeline)) {
+        return;
+    }
+
+    // Sent as binary messages so the pooled bytes go out without being
+    // converted to a QString and back to UTF-8
+    if (rectCount > 0) {
+        for (int i = 0; i < rectCount; ++i) {
+            m_streamingClient->sendBinaryMessage(frame->rectMessages[i]);
+            pipeline->bytesSent += frame->rectMessages[i].size();
+        }
+    } else {
+        m_streamingClient->sendBinaryMessage(frame->message);
+        pipeline->bytesSent += frame->message.size();
+    }
+
+    if (m_firstFrameTimer.isValid()) {
+        (m_resuming ? m_resumeToFrameMs : m_startToFrameMs) = m_firstFrameTimer.elapsed();
+        m_firstFrameTimer.invalidate();
+    }
+
+    if (++pipeline->frames == WarmUpFrames) {
+        pipeline->warmAllocations = pipeline->pool.allocations();
+    }
+}
+
+void ScreenShare::refineSettledRegions()
+{
+    if (!isStreaming() || !m_progressive) {
+        return;
+    }
+
+    bool pending = false;
+    for (const auto &pipeline : m_pipelines) {
+        pending = refineTarget(pipeline) || pending;
+    }
+    if (pending) {
+        m_refineTimer->start(SettleMs / 2);
+    }
+}
+
+bool ScreenShare::refineTarget(const std::shared_ptr<Pipeline> &pipeline)
+{
+    if (pipeline->busy) {
+        return true;
+    }
+    if (!pipeline->lastFrame) {
+        return false;
+    }
+
+    const qint64 now = m_clock.elapsed();
+    bool pending = false;
+    const QList<QRect> rects = settledRects(pipeline->tiles, now, &pending);
+    if (rects.isEmpty()) {
+        return pending;
+    }
+
+    FrameBufferRef refinement = pipeline->pool.acquire();
+    if (!refinement) {
+        return true;
+    }
+    for (const QRect &rect : rects) {
+        markRefined(pipeline->tiles, rect);
+    }
+
+    // One message per settled area, so areas far apart do not pull in
+    // everything between them
+    pipeline->busy = true;
+    m_encodePool.start([this, pipeline, refinement, rects]() {
+        const bool encoded = encodeRects(*pipeline, *refinement, pipeline->lastFrame->image, rects,
+                                         pipeline->refinePrefix, RefineQuality);
+        const int rectCount = int(rects.size());
+
+        QMetaObject::invokeMethod(this, [this, pipeline, refinement, encoded, rectCount]() {
+            pipeline->busy = false;
+            if (encoded && isStreaming() && m_pipelines.contains(pipeline)) {
+                for (int i = 0; i < rectCount; ++i) {
+                    m_streamingClient->sendBinaryMessage(refinement->rectMessages[i]);
+                    pipeline->bytesSent += refinement->rectMessages[i].size();
+                }
+                pipeline->refinements += rectCount;
+            }
+            if (pipeline->dirty) {
+                scheduleCapture();
+            }
+        }, Qt::QueuedConnection);
+    });
+    return pending;
 }
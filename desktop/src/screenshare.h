@@ -6,25 +6,114 @@
 #include <QObject>
 #include <QJsonObject>
 #include <QTimer>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <QRect>
+#include <QSize>
+#include <QList>
+#include <QSet>
+#include <memory>
+#include "framebufferpool.h"
 
 class QWebSocket;
+class DamageMonitor;
+class CursorTracker;
+class WindowTracker;
 
 class ScreenShare : public QObject
 {
     Q_OBJECT
 
 public:
-    explicit ScreenShare(QObject *parent = nullptr);
+    // Windows can only be streamed when a tracker is given
+    explicit ScreenShare(WindowTracker *windows = nullptr, QObject *parent = nullptr);
+    ~ScreenShare();
     
     void handleRequest(const QJsonObject &request, QWebSocket *client);
+    void clientDisconnected(QWebSocket *client);
+    // Moves the stream to a client's new connection after it resumed its session
+    void reattachClient(QWebSocket *from, QWebSocket *to);
 
 private slots:
     void captureAndSendFrame();
+    void refineSettledRegions();
+    void onDamaged(const QRect &rect);
+    void sendCursorPosition(const QPoint &position);
+    void onCursorShapeChanged(quint64 id);
+    void onWindowGeometryChanged(quint64 window);
+    void onWindowClosed(quint64 window);
 
 private:
-    void startStreaming(QWebSocket *client);
+    struct Pipeline;
+
+    void startStreaming(QWebSocket *client, const QJsonObject &request);
     void stopStreaming();
+    void listScreens(const QJsonObject &request, QWebSocket *client);
+    void selectScreens(const QJsonObject &request, QWebSocket *client);
+    void sendStats(QWebSocket *client);
+    void setViewport(const QJsonObject &request, QWebSocket *client);
+    void sendCursorShape(QWebSocket *client, quint64 id);
+
+    bool isStreaming() const;
+    void scheduleCapture();
+    void markAllDirty();
+
+    std::shared_ptr<Pipeline> createPipeline(const QString &target);
+    // Where a target is on the desktop, in global logical pixels
+    QRect targetGeometry(const QString &target) const;
+    void captureTarget(const std::shared_ptr<Pipeline> &pipeline);
+    bool refineTarget(const std::shared_ptr<Pipeline> &pipeline);
+    void sendEncodedFrame(const std::shared_ptr<Pipeline> &pipeline, const FrameBufferRef &frame, int rectCount);
+
+    // Run on the encoder pool
+    static bool encodeImage(Pipeline &pipeline, const QImage &image, QByteArray &encoded, int quality);
+    static void buildFrameMessage(Pipeline &pipeline, FrameBuffer &frame, const QByteArray &prefix);
+    static void buildStripedMessage(Pipeline &pipeline, FrameBuffer &frame, int stripeHeight);
+    static bool encodeRects(Pipeline &pipeline, FrameBuffer &frame, const QImage &image,
+                            const QList<QRect> &rects, const QByteArray &prefix, int quality);
     
     QWebSocket *m_streamingClient = nullptr;
+
+    // With damage notifications the timer is a single shot armed when
+    // something changes; without them it polls at a fixed interval and
+    // unchanged frames are detected by hashing
     QTimer *m_captureTimer;
+    DamageMonitor *m_damageMonitor;
+    QElapsedTimer m_sinceCapture;
+    int m_minFrameInterval = 33;
+
+    // One pipeline per selected screen (or one for the virtual desktop);
+    // each encodes on the thread pool independently of the others
+    QList<std::shared_ptr<Pipeline>> m_pipelines;
+    QThreadPool m_encodePool;
+
+    // Large frames can be split into stripes encoded in parallel. A separate
+    // pool keeps pipeline jobs, which wait for their stripes, from starving it.
+    QThreadPool m_stripePool;
+    int m_stripeCount = 1;
+
+    // Region of each target to stream in logical pixels; null means all of it.
+    // Frames are never scaled above the native size of the region.
+    QRect m_viewport;
+    QSize m_outputSize = QSize(1280, 720);
+
+    // Progressive mode sends the tiles that changed at low quality and later
+    // re-sends those that have settled at high quality
+    bool m_progressive = false;
+    QTimer *m_refineTimer;
+    QElapsedTimer m_clock;
+
+    // The pointer is not part of the frames; clients draw it from these
+    // messages and cache shapes by id, so each shape is sent once per stream
+    CursorTracker *m_cursorTracker;
+    QSet<quint64> m_sentCursorShapes;
+
+    WindowTracker *m_windows;
+
+    // Time to the first frame after a start and after a resume, to show
+    // what resuming saves over starting again
+    QElapsedTimer m_firstFrameTimer;
+    bool m_resuming = false;
+    qint64 m_startToFrameMs = -1;
+    qint64 m_resumeToFrameMs = -1;
 };
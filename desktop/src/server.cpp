@@ -7,20 +7,78 @@
 #include "filetransfer.h"
 #include "systemcontroller.h"
 #include "screenshare.h"
+#include "windowtracker.h"
+#include "audiostream.h"
+#include "telemetry.h"
+#include "processmonitor.h"
+#include "clipboardsync.h"
+#include "macroengine.h"
+#include "sessionrecorder.h"
+#include "commandscheduler.h"
+#include "localframeserver.h"
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QJsonArray>
+#include <QGuiApplication>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QTimer>
+#include <QtAlgorithms>
 #include <QDebug>
 
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+// How long a dropped client's state is kept for it to resume
+static const int ResumeGraceMs = 30000;
+// Replies kept for a client while it is away
+static const int MaxPendingReplies = 256;
+
 Server::Server(QObject *parent)
     : QObject(parent)
     , m_server(new QWebSocketServer("PC Remote Server", 
                                     QWebSocketServer::NonSecureMode, this))
-    , m_mediaController(std::make_unique<MediaController>())
-    , m_inputController(std::make_unique<InputController>())
-    , m_fileTransfer(std::make_unique<FileTransfer>())
-    , m_systemController(std::make_unique<SystemController>())
-    , m_screenShare(std::make_unique<ScreenShare>())
 {
+    m_uptime.start();
+
+    m_scheduler = new CommandScheduler(
+        [this](QWebSocket *client, const QJsonObject &command, const QByteArray &binary, qint64 queuedNs) {
+            QElapsedTimer dispatchTimer;
+            dispatchTimer.start();
+            if (binary.isEmpty()) {
+                handleCommand(client, command);
+            } else {
+                handleBinary(client, binary);
+            }
+            noteDispatchTime(queuedNs + dispatchTimer.nsecsElapsed());
+        },
+        this);
+
+    connect(m_scheduler, &CommandScheduler::discarded, this,
+            [this](QWebSocket *client, const QJsonObject &command, CommandScheduler::Discard reason) {
+        if (command.isEmpty()) {
+            return; // Binary payloads have no one to answer
+        }
+        QJsonObject response;
+        if (command["type"].toString() == "batch") {
+            response["type"] = "batch";
+        }
+        response["id"] = command["id"];
+        if (reason == CommandScheduler::Coalesced) {
+            // Superseded by a newer command of the same kind, which did run
+            if (command["noAck"].toBool()) {
+                ++m_acksSuppressed;
+                return;
+            }
+            response["status"] = "success";
+            response["coalesced"] = true;
+        } else {
+            response["status"] = "error";
+            response["message"] = "Too many queued commands";
+        }
+        sendResponse(client, response);
+    });
 }
 
 Server::~Server()
@@ -28,12 +86,12 @@ Server::~Server()
     stop();
 }
 
-bool Server::start(quint16 port)
+bool Server::start(quint16 port, const QHostAddress &address)
 {
-    if (m_server->listen(QHostAddress::Any, port)) {
+    if (m_server->listen(address, port)) {
         connect(m_server, &QWebSocketServer::newConnection,
                 this, &Server::onNewConnection);
-        qDebug() << "Server started on port" << port;
+        qDebug() << "Server started on" << address.toString() << "port" << port;
         return true;
     }
     
@@ -41,6 +99,45 @@ bool Server::start(quint16 port)
     return false;
 }
 
+quint16 Server::port() const
+{
+    return m_server->serverPort();
+}
+
+bool Server::startRecording(const QString &path)
+{
+    auto recorder = std::make_unique<SessionRecorder>();
+    if (!recorder->open(path)) {
+        return false;
+    }
+    m_recorder = std::move(recorder);
+    return true;
+}
+
+bool Server::startLocalTransport(const QString &path)
+{
+    if (!hasGuiApplication()) {
+        qWarning() << "The local frame transport needs a display";
+        return false;
+    }
+    auto localFrames = std::make_unique<LocalFrameServer>();
+    if (!localFrames->listen(path)) {
+        return false;
+    }
+    m_localFrames = std::move(localFrames);
+    return true;
+}
+
+void Server::setRateLimit(const QString &type, const RateLimit &limit)
+{
+    m_scheduler->setLimit(type, limit);
+}
+
+void Server::setUnlimited(bool unlimited)
+{
+    m_scheduler->setUnlimited(unlimited);
+}
+
 void Server::stop()
 {
     for (QWebSocket *client : m_clients) {
@@ -50,22 +147,236 @@ void Server::stop()
     m_server->close();
 }
 
+QJsonObject Server::status() const
+{
+    QJsonArray subsystems;
+    if (m_mediaController)
+        subsystems.append("media");
+    if (m_inputController)
+        subsystems.append("input");
+    if (m_fileTransfer)
+        subsystems.append("file");
+    if (m_systemController)
+        subsystems.append("system");
+    if (m_screenShare)
+        subsystems.append("screen");
+    if (m_windowTracker)
+        subsystems.append("window");
+    if (m_audioStream)
+        subsystems.append("audio");
+    if (m_telemetry)
+        subsystems.append("telemetry");
+    if (m_processMonitor)
+        subsystems.append("process");
+    if (m_clipboardSync)
+        subsystems.append("clipboard");
+    if (m_macroEngine)
+        subsystems.append("macro");
+
+    QJsonObject status;
+    status["version"] = "1.0.0";
+    status["uptimeMs"] = m_uptime.elapsed();
+    status["rssKb"] = residentSetSizeKb();
+    status["clients"] = m_clients.size();
+    status["gui"] = hasGuiApplication();
+    status["subsystems"] = subsystems;
+
+    QJsonObject traffic;
+    traffic["messagesIn"] = qint64(m_messagesIn);
+    traffic["bytesIn"] = qint64(m_bytesIn);
+    traffic["bytesOut"] = qint64(m_bytesOut);
+    traffic["commands"] = qint64(m_commands);
+    traffic["batches"] = qint64(m_batches);
+    traffic["acksSent"] = qint64(m_acksSent);
+    traffic["acksSuppressed"] = qint64(m_acksSuppressed);
+    status["traffic"] = traffic;
+
+    // Percentiles are the upper bound of their histogram bucket
+    auto percentileUs = [this](double fraction) {
+        const quint64 target = quint64(m_dispatchCount * fraction);
+        quint64 seen = 0;
+        for (size_t bucket = 0; bucket < m_dispatchHistogram.size(); ++bucket) {
+            seen += m_dispatchHistogram[bucket];
+            if (seen > target) {
+                return double(quint64(1) << bucket) / 1000.0;
+            }
+        }
+        return 0.0;
+    };
+    QJsonObject dispatch;
+    dispatch["count"] = qint64(m_dispatchCount);
+    dispatch["avgUs"] = m_dispatchCount ? m_dispatchTotalNs / 1000.0 / m_dispatchCount : 0.0;
+    dispatch["p50Us"] = percentileUs(0.5);
+    dispatch["p99Us"] = percentileUs(0.99);
+    dispatch["maxUs"] = m_dispatchMaxNs / 1000.0;
+    status["dispatch"] = dispatch;
+    status["scheduler"] = m_scheduler->stats();
+    if (m_localFrames) {
+        status["local"] = m_localFrames->stats();
+    }
+    status["dryRun"] = m_dryRun;
+    if (m_recorder) {
+        status["recordedMessages"] = qint64(m_recorder->records());
+    }
+
+    int parked = 0;
+    for (const Session &session : m_sessions) {
+        parked += session.parked ? 1 : 0;
+    }
+    QJsonObject sessions;
+    sessions["active"] = m_sessions.size() - parked;
+    sessions["parked"] = parked;
+    sessions["resumed"] = qint64(m_sessionsResumed);
+    sessions["expired"] = qint64(m_sessionsExpired);
+    status["sessions"] = sessions;
+    return status;
+}
+
+qint64 Server::residentSetSizeKb()
+{
+#ifdef Q_OS_LINUX
+    // Second field of statm is the resident set in pages
+    QFile statm("/proc/self/statm");
+    if (statm.open(QIODevice::ReadOnly)) {
+        const QList<QByteArray> fields = statm.readAll().split(' ');
+        if (fields.size() > 1) {
+            return fields[1].toLongLong() * sysconf(_SC_PAGESIZE) / 1024;
+        }
+    }
+#endif
+    return -1;
+}
+
+bool Server::hasGuiApplication()
+{
+    return qobject_cast<QGuiApplication *>(QCoreApplication::instance()) != nullptr;
+}
+
+MediaController *Server::mediaController()
+{
+    if (!m_mediaController) {
+        m_mediaController = std::make_unique<MediaController>();
+    }
+    return m_mediaController.get();
+}
+
+InputController *Server::inputController()
+{
+    if (!m_inputController) {
+        m_inputController = std::make_unique<InputController>();
+    }
+    return m_inputController.get();
+}
+
+FileTransfer *Server::fileTransfer()
+{
+    if (!m_fileTransfer) {
+        m_fileTransfer = std::make_unique<FileTransfer>();
+    }
+    return m_fileTransfer.get();
+}
+
+SystemController *Server::systemController()
+{
+    if (!m_systemController) {
+        m_systemController = std::make_unique<SystemController>();
+    }
+    return m_systemController.get();
+}
+
+ScreenShare *Server::screenShare()
+{
+    if (!m_screenShare) {
+        m_screenShare = std::make_unique<ScreenShare>(windowTracker());
+    }
+    return m_screenShare.get();
+}
+
+WindowTracker *Server::windowTracker()
+{
+    if (!m_windowTracker) {
+        m_windowTracker = std::make_unique<WindowTracker>();
+    }
+    return m_windowTracker.get();
+}
+
+AudioStream *Server::audioStream()
+{
+    if (!m_audioStream) {
+        m_audioStream = std::make_unique<AudioStream>();
+    }
+    return m_audioStream.get();
+}
+
+Telemetry *Server::telemetry()
+{
+    if (!m_telemetry) {
+        m_telemetry = std::make_unique<Telemetry>();
+    }
+    return m_telemetry.get();
+}
+
+ProcessMonitor *Server::processMonitor()
+{
+    if (!m_processMonitor) {
+        m_processMonitor = std::make_unique<ProcessMonitor>();
+    }
+    return m_processMonitor.get();
+}
+
+ClipboardSync *Server::clipboardSync()
+{
+    if (!m_clipboardSync) {
+        m_clipboardSync = std::make_unique<ClipboardSync>();
+    }
+    return m_clipboardSync.get();
+}
+
+MacroEngine *Server::macroEngine()
+{
+    if (!m_macroEngine) {
+        m_macroEngine = std::make_unique<MacroEngine>(inputController(), mediaController());
+    }
+    return m_macroEngine.get();
+}
+
 void Server::onNewConnection()
 {
     QWebSocket *socket = m_server->nextPendingConnection();
     
     connect(socket, &QWebSocket::textMessageReceived,
             this, &Server::onTextMessageReceived);
+    connect(socket, &QWebSocket::binaryMessageReceived,
+            this, &Server::onBinaryMessageReceived);
     connect(socket, &QWebSocket::disconnected,
             this, &Server::onSocketDisconnected);
+    // Counts everything written to the socket, including controller traffic
+    connect(socket, &QWebSocket::bytesWritten, this, [this](qint64 bytes) {
+        m_bytesOut += bytes;
+    });
     
     m_clients.append(socket);
+    m_clientNumbers.insert(socket, m_nextClientNumber++);
+    if (m_recorder) {
+        m_recorder->record(SessionRecord::Connect, m_clientNumbers.value(socket));
+    }
     qDebug() << "New client connected:" << socket->peerAddress().toString();
+
+    quint32 random[4];
+    QRandomGenerator::system()->fillRange(random);
+    const QString token = QString::fromLatin1(
+        QByteArray(reinterpret_cast<const char *>(random), sizeof(random)).toHex());
+    Session session;
+    session.socket = socket;
+    m_sessions.insert(token, session);
+    m_sessionTokens.insert(socket, token);
     
     // Send welcome message
     QJsonObject response;
     response["type"] = "welcome";
     response["version"] = "1.0.0";
+    response["session"] = token;
+    response["resumeMs"] = ResumeGraceMs;
     socket->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
 }
 
@@ -75,59 +386,372 @@ void Server::onTextMessageReceived(const QString &message)
     if (!client)
         return;
     
-    QJsonDocument doc = QJsonDocument::fromJson(message.toUtf8());
+    const QByteArray utf8 = message.toUtf8();
+    ++m_messagesIn;
+    m_bytesIn += utf8.size();
+    if (m_recorder) {
+        m_recorder->record(SessionRecord::Text, m_clientNumbers.value(client), utf8);
+    }
+
+    QJsonDocument doc = QJsonDocument::fromJson(utf8);
     if (!doc.isObject()) {
         qWarning() << "Received invalid JSON";
         return;
     }
     
-    handleCommand(client, doc.object());
+    m_scheduler->enqueue(client, doc.object());
+}
+
+void Server::noteDispatchTime(qint64 ns)
+{
+    const int bucket = ns > 0 ? 64 - qCountLeadingZeroBits(quint64(ns)) : 0;
+    ++m_dispatchHistogram[qMin(bucket, int(m_dispatchHistogram.size()) - 1)];
+    ++m_dispatchCount;
+    m_dispatchTotalNs += ns;
+    m_dispatchMaxNs = qMax(m_dispatchMaxNs, ns);
+}
+
+void Server::onBinaryMessageReceived(const QByteArray &message)
+{
+    QWebSocket *client = qobject_cast<QWebSocket *>(sender());
+    if (!client)
+        return;
+
+    ++m_messagesIn;
+    m_bytesIn += message.size();
+    if (m_recorder) {
+        m_recorder->record(SessionRecord::Binary, m_clientNumbers.value(client), message);
+    }
+    if (message.isEmpty()) {
+        return;
+    }
+
+    m_scheduler->enqueueBinary(client, message);
+}
+
+void Server::handleBinary(QWebSocket *client, const QByteArray &message)
+{
+    // Binary messages only carry bulk payloads announced by a text command
+    if (ClipboardSync::isChunk(message) && m_clipboardSync) {
+        m_clipboardSync->handleBinary(message, client);
+    } else {
+        qWarning() << "Received unexpected binary message";
+    }
 }
 
 void Server::onSocketDisconnected()
 {
     QWebSocket *client = qobject_cast<QWebSocket *>(sender());
-    if (client) {
-        m_clients.removeAll(client);
-        client->deleteLater();
+    if (!client) {
+        return;
+    }
+
+    m_clients.removeAll(client);
+    if (m_recorder) {
+        m_recorder->record(SessionRecord::Disconnect, m_clientNumbers.value(client));
+    }
+    m_clientNumbers.remove(client);
+
+    // A dropped connection cannot be told apart from a deliberate close,
+    // so every session waits for a resume unless the client ended it
+    const QString token = m_sessionTokens.value(client);
+    auto session = m_sessions.find(token);
+    if (session == m_sessions.end()) {
+        releaseClient(client);
         qDebug() << "Client disconnected";
+        return;
+    }
+
+    // Commands still queued wait for the client to come back, so replies
+    // that controllers send straight to the socket are not lost on it
+    session->parked = true;
+    m_scheduler->pauseClient(client);
+    const quint64 generation = ++session->generation;
+    QTimer::singleShot(ResumeGraceMs, this, [this, token, generation]() {
+        auto it = m_sessions.find(token);
+        if (it != m_sessions.end() && it->parked && it->generation == generation) {
+            QWebSocket *socket = it->socket;
+            m_sessions.erase(it);
+            ++m_sessionsExpired;
+            releaseClient(socket);
+        }
+    });
+    qDebug() << "Client disconnected, session kept for" << ResumeGraceMs << "ms";
+}
+
+void Server::releaseClient(QWebSocket *client)
+{
+    if (m_screenShare) {
+        m_screenShare->clientDisconnected(client);
+    }
+    if (m_audioStream) {
+        m_audioStream->clientDisconnected(client);
+    }
+    if (m_mediaController) {
+        m_mediaController->clientDisconnected(client);
+    }
+    if (m_telemetry) {
+        m_telemetry->clientDisconnected(client);
+    }
+    if (m_processMonitor) {
+        m_processMonitor->clientDisconnected(client);
+    }
+    if (m_clipboardSync) {
+        m_clipboardSync->clientDisconnected(client);
+    }
+    if (m_macroEngine) {
+        m_macroEngine->clientDisconnected(client);
+    }
+    m_scheduler->removeClient(client);
+    m_sessionTokens.remove(client);
+    client->deleteLater();
+}
+
+void Server::reattachClient(QWebSocket *from, QWebSocket *to, const QJsonObject &received)
+{
+    if (m_screenShare) {
+        m_screenShare->reattachClient(from, to);
+    }
+    if (m_audioStream) {
+        m_audioStream->reattachClient(from, to);
+    }
+    if (m_mediaController) {
+        m_mediaController->reattachClient(from, to);
+    }
+    if (m_telemetry) {
+        m_telemetry->reattachClient(from, to);
+    }
+    if (m_processMonitor) {
+        m_processMonitor->reattachClient(from, to);
+    }
+    if (m_clipboardSync) {
+        m_clipboardSync->reattachClient(from, to, received);
+    }
+    if (m_macroEngine) {
+        m_macroEngine->reattachClient(from, to);
+    }
+}
+
+void Server::resumeSession(QWebSocket *client, const QJsonObject &request)
+{
+    QJsonObject response;
+    response["type"] = "session";
+    response["action"] = "resume";
+    response["id"] = request["id"];
+
+    const QString token = request["token"].toString();
+    auto session = m_sessions.find(token);
+    if (session == m_sessions.end() || !session->parked) {
+        response["status"] = "error";
+        response["message"] = "Unknown or expired session";
+        sendResponse(client, response);
+        return;
+    }
+
+    // The new connection takes over the old session and gives up its own
+    QWebSocket *previous = session->socket;
+    const QList<QJsonObject> pending = std::move(session->pending);
+    session->socket = client;
+    session->parked = false;
+    session->pending.clear();
+    m_sessions.remove(m_sessionTokens.value(client));
+    m_sessionTokens.insert(client, token);
+    m_sessionTokens.remove(previous);
+    m_scheduler->reattachClient(previous, client);
+    ++m_sessionsResumed;
+
+    response["status"] = "success";
+    response["session"] = token;
+    response["replayed"] = pending.size();
+    if (m_clipboardSync) {
+        response["uploads"] = m_clipboardSync->uploadOffsets(previous);
+    }
+    sendResponse(client, response);
+    for (const QJsonObject &reply : pending) {
+        sendResponse(client, reply);
     }
+
+    // Controllers resend their state and pick up streams and transfers
+    reattachClient(previous, client, request["received"].toObject());
+    previous->deleteLater();
+    qDebug() << "Client resumed its session";
 }
 
 void Server::handleCommand(QWebSocket *client, const QJsonObject &command)
 {
+    if (command["type"].toString() == "batch") {
+        handleBatch(client, command);
+        return;
+    }
+
+    QJsonObject response = executeCommand(client, command);
+    if (response.isEmpty()) {
+        return;
+    }
+
+    // Fire-and-forget commands only hear back when something went wrong
+    if (command["noAck"].toBool() && response["status"].toString() == "success") {
+        ++m_acksSuppressed;
+        return;
+    }
+    sendResponse(client, response);
+}
+
+void Server::handleBatch(QWebSocket *client, const QJsonObject &batch)
+{
+    ++m_batches;
+
+    // Items run in order within this event-loop pass and share a single
+    // acknowledgement: one status per item, with details for failures only
+    const QJsonArray commands = batch["commands"].toArray();
+    QJsonArray results;
+    QJsonArray errors;
+    for (int i = 0; i < commands.size(); ++i) {
+        const QJsonObject command = commands[i].toObject();
+
+        QJsonObject result;
+        if (command["type"].toString() == "batch") {
+            result["status"] = "error";
+            result["message"] = "Batches cannot be nested";
+        } else {
+            result = executeCommand(client, command);
+        }
+
+        // Items whose controller answers by itself are reported as accepted
+        const QString status = result.isEmpty() ? QString("accepted") : result["status"].toString();
+        results.append(status);
+        if (status == "error") {
+            QJsonObject error;
+            error["index"] = i;
+            error["message"] = result["message"];
+            errors.append(error);
+        }
+    }
+
+    if (batch["noAck"].toBool() && errors.isEmpty()) {
+        ++m_acksSuppressed;
+        return;
+    }
+
+    QJsonObject response;
+    response["type"] = "batch";
+    response["id"] = batch["id"];
+    response["status"] = errors.isEmpty() ? "success" : "error";
+    response["results"] = results;
+    if (!errors.isEmpty()) {
+        response["errors"] = errors;
+    }
+    sendResponse(client, response);
+}
+
+void Server::sendResponse(QWebSocket *client, const QJsonObject &response)
+{
+    if (!client->isValid()) {
+        // Held for a client that may resume: answers to commands that ran
+        // as its connection dropped, before the scheduler paused it
+        auto session = m_sessions.find(m_sessionTokens.value(client));
+        if (session != m_sessions.end() && session->parked
+            && session->pending.size() < MaxPendingReplies) {
+            session->pending.append(response);
+        }
+        return;
+    }
+    ++m_acksSent;
+    client->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
+}
+
+QJsonObject Server::executeCommand(QWebSocket *client, const QJsonObject &command)
+{
+    ++m_commands;
     QString type = command["type"].toString();
     
     QJsonObject response;
     response["id"] = command["id"];
     
-    if (type == "media") {
+    if (m_dryRun && type != "server") {
+        // Parsed and dispatched, but no controller runs
+        response["status"] = "success";
+    }
+    else if (type == "media") {
         QString action = command["action"].toString();
-        m_mediaController->handleAction(action, command);
+        if (action == "state" || action == "subscribe" || action == "unsubscribe") {
+            mediaController()->handleRequest(command, client);
+            return QJsonObject(); // State replies carry their own response
+        }
+        mediaController()->handleAction(action, command);
         response["status"] = "success";
     }
+    else if ((type == "input" || type == "screen" || type == "window" || type == "clipboard"
+              || type == "macro") && !hasGuiApplication()) {
+        response["status"] = "error";
+        response["message"] = "Not available without a display";
+    }
     else if (type == "input") {
         QString action = command["action"].toString();
-        m_inputController->handleAction(action, command);
+        inputController()->handleAction(action, command);
         response["status"] = "success";
     }
     else if (type == "file") {
-        m_fileTransfer->handleRequest(command, client);
-        return; // File transfer handles its own response
+        fileTransfer()->handleRequest(command, client);
+        return QJsonObject(); // File transfer handles its own response
     }
     else if (type == "system") {
         QString action = command["action"].toString();
-        m_systemController->handleAction(action);
+        systemController()->handleAction(action);
         response["status"] = "success";
     }
     else if (type == "screen") {
-        m_screenShare->handleRequest(command, client);
-        return; // Screen share handles its own response
+        screenShare()->handleRequest(command, client);
+        return QJsonObject(); // Screen share handles its own response
+    }
+    else if (type == "window") {
+        windowTracker()->handleRequest(command, client);
+        return QJsonObject(); // Window tracker handles its own response
+    }
+    else if (type == "audio") {
+        audioStream()->handleRequest(command, client);
+        return QJsonObject(); // Audio stream handles its own response
+    }
+    else if (type == "telemetry") {
+        telemetry()->handleRequest(command, client);
+        return QJsonObject(); // Telemetry handles its own response
+    }
+    else if (type == "process") {
+        processMonitor()->handleRequest(command, client);
+        return QJsonObject(); // Process monitor handles its own response
+    }
+    else if (type == "clipboard") {
+        clipboardSync()->handleRequest(command, client);
+        return QJsonObject(); // Clipboard sync handles its own response
+    }
+    else if (type == "macro") {
+        macroEngine()->handleRequest(command, client);
+        return QJsonObject(); // Macro engine handles its own response
+    }
+    else if (type == "session") {
+        const QString action = command["action"].toString();
+        if (action == "resume") {
+            resumeSession(client, command);
+            return QJsonObject(); // Resuming answers by itself
+        }
+        if (action == "end") {
+            // State is released as soon as the connection closes
+            m_sessions.remove(m_sessionTokens.value(client));
+            response["status"] = "success";
+        } else {
+            response["status"] = "error";
+            response["message"] = "Unknown session action";
+        }
+    }
+    else if (type == "server" && command["action"].toString() == "status") {
+        response["type"] = "server";
+        response["status"] = "success";
+        response["data"] = status();
     }
     else {
         response["status"] = "error";
         response["message"] = "Unknown command type";
     }
     
-    client->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
+    return response;
 }
@@ -6,7 +6,12 @@
 #include <QObject>
 #include <QWebSocketServer>
 #include <QWebSocket>
+#include <QHostAddress>
+#include <QJsonObject>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QList>
+#include <array>
 #include <memory>
 
 class MediaController;
@@ -14,6 +19,16 @@ class InputController;
 class FileTransfer;
 class SystemController;
 class ScreenShare;
+class AudioStream;
+class Telemetry;
+class ProcessMonitor;
+class ClipboardSync;
+class WindowTracker;
+class MacroEngine;
+class SessionRecorder;
+class CommandScheduler;
+class LocalFrameServer;
+struct RateLimit;
 
 class Server : public QObject
 {
@@ -23,23 +38,117 @@ public:
     explicit Server(QObject *parent = nullptr);
     ~Server();
 
-    bool start(quint16 port);
+    bool start(quint16 port, const QHostAddress &address = QHostAddress::Any);
     void stop();
+    quint16 port() const;
+
+    // Appends every inbound message to a session log for later replay
+    bool startRecording(const QString &path);
+    // Serves raw frames to consumers on this machine over a Unix socket
+    bool startLocalTransport(const QString &path);
+    // Acknowledges commands without running them, for replaying sessions
+    // against a server that must not touch the machine
+    void setDryRun(bool dryRun) { m_dryRun = dryRun; }
+    // Overrides the per-client command rate for one command type
+    void setRateLimit(const QString &type, const RateLimit &limit);
+    // Turns off rate limits and coalescing, for replays that measure dispatch
+    void setUnlimited(bool unlimited);
+
+    QJsonObject status() const;
+    static qint64 residentSetSizeKb();
 
 private slots:
     void onNewConnection();
     void onTextMessageReceived(const QString &message);
+    void onBinaryMessageReceived(const QByteArray &message);
     void onSocketDisconnected();
 
 private:
     void handleCommand(QWebSocket *client, const QJsonObject &command);
+    void handleBatch(QWebSocket *client, const QJsonObject &batch);
+    void handleBinary(QWebSocket *client, const QByteArray &message);
+    // Runs one command and returns its acknowledgement, or an empty object
+    // when the controller answers the client itself
+    QJsonObject executeCommand(QWebSocket *client, const QJsonObject &command);
+    void sendResponse(QWebSocket *client, const QJsonObject &response);
+    void resumeSession(QWebSocket *client, const QJsonObject &request);
+    void reattachClient(QWebSocket *from, QWebSocket *to, const QJsonObject &received);
+    // Tells every controller that a client is gone for good
+    void releaseClient(QWebSocket *client);
+    void noteDispatchTime(qint64 ns);
+    static bool hasGuiApplication();
+
+    // Controllers are created on first use so that startup does not pay for
+    // subsystems a session never touches.
+    MediaController *mediaController();
+    InputController *inputController();
+    FileTransfer *fileTransfer();
+    SystemController *systemController();
+    ScreenShare *screenShare();
+    WindowTracker *windowTracker();
+    AudioStream *audioStream();
+    Telemetry *telemetry();
+    ProcessMonitor *processMonitor();
+    ClipboardSync *clipboardSync();
+    MacroEngine *macroEngine();
 
     QWebSocketServer *m_server;
+    // Inbound messages run from here, fairly across clients
+    CommandScheduler *m_scheduler;
     QList<QWebSocket *> m_clients;
+    QElapsedTimer m_uptime;
+
+    // Wire traffic, reported by server/status
+    quint64 m_messagesIn = 0;
+    quint64 m_bytesIn = 0;
+    quint64 m_bytesOut = 0;
+    quint64 m_commands = 0;
+    quint64 m_batches = 0;
+    quint64 m_acksSent = 0;
+    quint64 m_acksSuppressed = 0;
+
+    // Time from receiving a message to finishing its dispatch, as a log2
+    // histogram of nanoseconds
+    std::array<quint64, 64> m_dispatchHistogram{};
+    quint64 m_dispatchCount = 0;
+    qint64 m_dispatchTotalNs = 0;
+    qint64 m_dispatchMaxNs = 0;
+
+    bool m_dryRun = false;
+    std::unique_ptr<SessionRecorder> m_recorder;
+    std::unique_ptr<LocalFrameServer> m_localFrames;
+    QHash<QWebSocket *, quint16> m_clientNumbers;
+    quint16 m_nextClientNumber = 0;
+
+    // Each connection gets a session token in its welcome. When the
+    // connection drops, its socket stays known to the controllers for a
+    // grace period, so a client that reconnects and resumes gets its
+    // subscriptions and transfers back instead of starting over.
+    struct Session
+    {
+        QWebSocket *socket = nullptr;
+        bool parked = false;
+        // Counts parkings, so a grace timer left from an earlier one can
+        // tell that the session was resumed in the meantime
+        quint64 generation = 0;
+        QList<QJsonObject> pending; // Replies that found the connection gone
+    };
+    QHash<QString, Session> m_sessions;
+    QHash<QWebSocket *, QString> m_sessionTokens;
+    quint64 m_sessionsResumed = 0;
+    quint64 m_sessionsExpired = 0;
     
     std::unique_ptr<MediaController> m_mediaController;
     std::unique_ptr<InputController> m_inputController;
     std::unique_ptr<FileTransfer> m_fileTransfer;
     std::unique_ptr<SystemController> m_systemController;
+    // Declared first so it outlives the screen share that streams its windows
+    std::unique_ptr<WindowTracker> m_windowTracker;
     std::unique_ptr<ScreenShare> m_screenShare;
+    std::unique_ptr<AudioStream> m_audioStream;
+    std::unique_ptr<Telemetry> m_telemetry;
+    std::unique_ptr<ProcessMonitor> m_processMonitor;
+    std::unique_ptr<ClipboardSync> m_clipboardSync;
+    // Drives the input and media controllers, so it goes first
+    std::unique_ptr<MacroEngine> m_macroEngine;
 };
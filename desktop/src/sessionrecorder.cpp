@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#include "sessionrecorder.h"
+#include <QTimer>
+#include <QtEndian>
+#include <QDebug>
+#include <cstring>
+
+// At most this much of a session is lost if the server dies
+static const int FlushIntervalMs = 1000;
+
+SessionRecorder::SessionRecorder(QObject *parent)
+    : QObject(parent)
+    , m_flushTimer(new QTimer(this))
+{
+    connect(m_flushTimer, &QTimer::timeout, this, &SessionRecorder::flush);
+}
+
+SessionRecorder::~SessionRecorder()
+{
+    flush();
+}
+
+bool SessionRecorder::open(const QString &path)
+{
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Failed to open session log" << path << m_file.errorString();
+        return false;
+    }
+
+    uchar header[SessionRecord::FileHeaderSize] = {};
+    memcpy(header, SessionRecord::Magic, sizeof(SessionRecord::Magic));
+    qToLittleEndian<quint32>(SessionRecord::Version, header + 8);
+    m_file.write(reinterpret_cast<const char *>(header), sizeof(header));
+
+    m_clock.start();
+    m_flushTimer->start(FlushIntervalMs);
+    qDebug() << "Recording session to" << path;
+    return true;
+}
+
+void SessionRecorder::record(SessionRecord::Kind kind, quint16 client, const QByteArray &payload)
+{
+    if (!m_file.isOpen()) {
+        return;
+    }
+
+    uchar header[SessionRecord::RecordHeaderSize] = {};
+    qToLittleEndian<quint64>(quint64(m_clock.nsecsElapsed()), header);
+    qToLittleEndian<quint32>(quint32(payload.size()), header + 8);
+    qToLittleEndian<quint16>(client, header + 12);
+    header[14] = kind;
+
+    // QFile buffers these writes; the timer bounds how long they wait
+    static const char padding[8] = {};
+    m_file.write(reinterpret_cast<const char *>(header), sizeof(header));
+    m_file.write(payload);
+    m_file.write(padding, SessionRecord::paddedSize(payload.size()) - payload.size());
+    ++m_records;
+}
+
+void SessionRecorder::flush()
+{
+    if (m_file.isOpen()) {
+        m_file.flush();
+    }
+}
@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+
+class QTimer;
+
+// Append-only log of client traffic, for replaying real sessions later.
+//
+// The file starts with a 16-byte header, magic "PCRSESS\0" and a u32
+// version, followed by records aligned to 8 bytes so the log can be
+// memory-mapped and walked in place (little endian):
+//   0  8  nanoseconds since recording started
+//   8  4  payload length
+//  12  2  client number, unique for the recording
+//  14  1  SessionRecord::Kind
+//  15  1  reserved
+//  16     payload, padded to a multiple of 8
+namespace SessionRecord {
+enum Kind : quint8 {
+    Text = 0,
+    Binary = 1,
+    Connect = 2,
+    Disconnect = 3,
+};
+
+static const char Magic[8] = { 'P', 'C', 'R', 'S', 'E', 'S', 'S', '\0' };
+static const quint32 Version = 1;
+static const int FileHeaderSize = 16;
+static const int RecordHeaderSize = 16;
+
+inline qsizetype paddedSize(qsizetype length)
+{
+    return (length + 7) & ~qsizetype(7);
+}
+}
+
+class SessionRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SessionRecorder(QObject *parent = nullptr);
+    ~SessionRecorder();
+
+    bool open(const QString &path);
+    void record(SessionRecord::Kind kind, quint16 client, const QByteArray &payload = QByteArray());
+    void flush();
+
+    quint64 records() const { return m_records; }
+
+private:
+    QFile m_file;
+    QElapsedTimer m_clock;
+    QTimer *m_flushTimer;
+    quint64 m_records = 0;
+};
@@ -0,0 +1,163 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#include "sessionreplay.h"
+#include "sessionrecorder.h"
+#include <QTimer>
+#include <QWebSocket>
+#include <QtEndian>
+#include <QDebug>
+#include <cstring>
+
+// Time allowed for replies to the last messages before finishing
+static const int DrainMs = 500;
+
+SessionReplay::SessionReplay(QObject *parent)
+    : QObject(parent)
+{
+}
+
+SessionReplay::~SessionReplay()
+{
+    qDeleteAll(m_sockets);
+}
+
+bool SessionReplay::load(const QString &path)
+{
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Failed to open session log" << path << m_file.errorString();
+        return false;
+    }
+
+    const qint64 size = m_file.size();
+    const uchar *data = size > 0 ? m_file.map(0, size) : nullptr;
+    if (!data || size < SessionRecord::FileHeaderSize
+        || memcmp(data, SessionRecord::Magic, sizeof(SessionRecord::Magic)) != 0
+        || qFromLittleEndian<quint32>(data + 8) != SessionRecord::Version) {
+        qWarning() << "Not a session log:" << path;
+        return false;
+    }
+
+    // Index the records; payloads stay in the mapping
+    qint64 offset = SessionRecord::FileHeaderSize;
+    while (offset + SessionRecord::RecordHeaderSize <= size) {
+        const uchar *header = data + offset;
+        Record record;
+        record.timeNs = qFromLittleEndian<quint64>(header);
+        record.length = qFromLittleEndian<quint32>(header + 8);
+        record.client = qFromLittleEndian<quint16>(header + 12);
+        record.kind = header[14];
+        record.payload = reinterpret_cast<const char *>(header + SessionRecord::RecordHeaderSize);
+
+        const qint64 next = offset + SessionRecord::RecordHeaderSize + SessionRecord::paddedSize(record.length);
+        if (offset + SessionRecord::RecordHeaderSize + record.length > size) {
+            qWarning() << "Session log is truncated; replaying" << m_records.size() << "records";
+            break;
+        }
+        m_records.append(record);
+        offset = next;
+    }
+
+    qDebug() << "Loaded" << m_records.size() << "records from" << path;
+    return true;
+}
+
+void SessionReplay::start(const QUrl &url, double speed)
+{
+    m_url = url;
+    m_speed = speed;
+    m_next = 0;
+    m_lastActivityNs = 0;
+    m_elapsed.start();
+    scheduleNext();
+}
+
+void SessionReplay::scheduleNext()
+{
+    if (m_next >= m_records.size()) {
+        QTimer::singleShot(DrainMs, this, &SessionReplay::finished);
+        return;
+    }
+
+    qint64 delayMs = 0;
+    if (m_speed > 0) {
+        const qint64 dueNs = qint64(m_records[m_next].timeNs / m_speed);
+        delayMs = qMax<qint64>(0, (dueNs - m_elapsed.nsecsElapsed()) / 1000000);
+    }
+    QTimer::singleShot(int(delayMs), Qt::PreciseTimer, this, &SessionReplay::playDue);
+}
+
+void SessionReplay::playDue()
+{
+    const qint64 now = m_elapsed.nsecsElapsed();
+    while (m_next < m_records.size()) {
+        const Record &record = m_records[m_next];
+        if (m_speed > 0 && qint64(record.timeNs / m_speed) > now) {
+            break;
+        }
+        play(record);
+        ++m_next;
+    }
+    scheduleNext();
+}
+
+void SessionReplay::play(const Record &record)
+{
+    if (record.kind == SessionRecord::Connect) {
+        auto *socket = new QWebSocket;
+        m_sockets.insert(record.client, socket);
+        m_waiting.insert(socket, QList<Record>());
+
+        connect(socket, &QWebSocket::connected, this, [this, socket]() {
+            const QList<Record> waiting = m_waiting.take(socket);
+            for (const Record &pending : waiting) {
+                send(socket, pending);
+            }
+        });
+        connect(socket, &QWebSocket::textMessageReceived, this, [this]() {
+            ++m_messagesReceived;
+            m_lastActivityNs = m_elapsed.nsecsElapsed();
+        });
+        connect(socket, &QWebSocket::binaryMessageReceived, this, [this]() {
+            ++m_messagesReceived;
+            m_lastActivityNs = m_elapsed.nsecsElapsed();
+        });
+        socket->open(m_url);
+        return;
+    }
+
+    QWebSocket *socket = m_sockets.value(record.client);
+    if (!socket) {
+        return; // Client connected before the recording started
+    }
+
+    if (record.kind == SessionRecord::Disconnect) {
+        m_sockets.remove(record.client);
+        m_waiting.remove(socket);
+        socket->close();
+        socket->deleteLater();
+        return;
+    }
+
+    auto waiting = m_waiting.find(socket);
+    if (waiting != m_waiting.end()) {
+        waiting->append(record);
+        return;
+    }
+    send(socket, record);
+}
+
+void SessionReplay::send(QWebSocket *socket, const Record &record)
+{
+    if (record.kind == SessionRecord::Text) {
+        socket->sendTextMessage(QString::fromUtf8(record.payload, record.length));
+    } else if (record.kind == SessionRecord::Binary) {
+        socket->sendBinaryMessage(QByteArray::fromRawData(record.payload, record.length));
+    } else {
+        return;
+    }
+    ++m_messagesSent;
+    m_bytesSent += record.length;
+    m_lastActivityNs = m_elapsed.nsecsElapsed();
+}
@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#pragma once
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QUrl>
+
+class QWebSocket;
+
+// Plays a log written by SessionRecorder against a server over real
+// WebSocket connections, one per recorded client, either with the
+// original timing scaled by a speed factor or as fast as possible
+// (speed 0). The log is memory-mapped and walked in place.
+class SessionReplay : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SessionReplay(QObject *parent = nullptr);
+    ~SessionReplay();
+
+    bool load(const QString &path);
+    void start(const QUrl &url, double speed);
+
+    quint64 messagesSent() const { return m_messagesSent; }
+    quint64 bytesSent() const { return m_bytesSent; }
+    quint64 messagesReceived() const { return m_messagesReceived; }
+    // From the start to the last message sent or reply received, whichever
+    // came later; the wait for late replies before finishing is not counted
+    qint64 elapsedNs() const { return m_lastActivityNs; }
+
+signals:
+    void finished();
+
+private:
+    struct Record
+    {
+        quint64 timeNs;
+        quint16 client;
+        quint8 kind;
+        const char *payload;
+        quint32 length;
+    };
+
+    void scheduleNext();
+    void playDue();
+    void play(const Record &record);
+    void send(QWebSocket *socket, const Record &record);
+
+    QFile m_file;
+    QList<Record> m_records;
+    int m_next = 0;
+
+    QUrl m_url;
+    double m_speed = 1.0;
+    QElapsedTimer m_elapsed;
+    qint64 m_lastActivityNs = 0;
+
+    QHash<quint16, QWebSocket *> m_sockets;
+    // Messages recorded before the replayed connection was established
+    QHash<QWebSocket *, QList<Record>> m_waiting;
+
+    quint64 m_messagesSent = 0;
+    quint64 m_bytesSent = 0;
+    quint64 m_messagesReceived = 0;
+};
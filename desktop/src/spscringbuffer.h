@@ -0,0 +1,76 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Lock-free ring buffer for exactly one producer thread and one consumer
+// thread. Capacity is rounded up to a power of two.
+template <typename T>
+class SpscRingBuffer
+{
+public:
+    explicit SpscRingBuffer(size_t capacity)
+    {
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        m_buffer.resize(size);
+        m_mask = size - 1;
+    }
+
+    // Producer side; returns how many items fit
+    size_t write(const T *data, size_t count)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+        const size_t space = m_buffer.size() - (head - tail);
+        if (count > space) {
+            count = space;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            m_buffer[(head + i) & m_mask] = data[i];
+        }
+        m_head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side; returns how many items were read
+    size_t read(T *data, size_t count)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t head = m_head.load(std::memory_order_acquire);
+        if (count > head - tail) {
+            count = head - tail;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            data[i] = m_buffer[(tail + i) & m_mask];
+        }
+        m_tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    size_t available() const
+    {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+
+    // Only valid while neither side is running
+    void reset()
+    {
+        m_head.store(0, std::memory_order_relaxed);
+        m_tail.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::vector<T> m_buffer;
+    size_t m_mask = 0;
+
+    // Kept on separate cache lines so the two threads do not contend
+    alignas(64) std::atomic<size_t> m_head{0};
+    alignas(64) std::atomic<size_t> m_tail{0};
+};
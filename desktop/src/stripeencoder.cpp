@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#include "stripeencoder.h"
+#include "framebufferpool.h"
+#include <QSemaphore>
+#include <QThreadPool>
+#include <QDebug>
+#include <atomic>
+
+static const int McuHeight = 16;
+
+StripeEncoder::Worker::Worker()
+{
+    writer.setDevice(&buffer);
+    writer.setFormat("JPEG");
+}
+
+bool StripeEncoder::Worker::encode(const QImage &image, int quality, QByteArray &output)
+{
+    output.resize(0);
+    writer.setQuality(quality);
+    buffer.setBuffer(&output);
+    buffer.open(QIODevice::WriteOnly);
+    const bool ok = writer.write(image);
+    buffer.close();
+    return ok;
+}
+
+StripeEncoder::StripeEncoder(QThreadPool *threadPool)
+    : m_threadPool(threadPool)
+{
+}
+
+StripeEncoder::~StripeEncoder() = default;
+
+int StripeEncoder::stripeHeight(int imageHeight, int stripeCount)
+{
+    const int height = (imageHeight + stripeCount - 1) / qMax(1, stripeCount);
+    return qMax(McuHeight, (height + McuHeight - 1) / McuHeight * McuHeight);
+}
+
+int StripeEncoder::stripeCount(int imageHeight, int stripeHeight)
+{
+    return (imageHeight + stripeHeight - 1) / stripeHeight;
+}
+
+bool StripeEncoder::encode(const QImage &image, int stripeHeight, int quality,
+                           QVector<QByteArray> &outputs, FrameBufferPool &bufferPool)
+{
+    const int count = stripeCount(image.height(), stripeHeight);
+
+    while (int(m_workers.size()) < count) {
+        m_workers.push_back(std::make_unique<Worker>());
+        bufferPool.noteAllocation();
+    }
+    if (outputs.size() < count) {
+        outputs.resize(count);
+        bufferPool.noteAllocation();
+    }
+
+    m_capacities.resize(count);
+    for (int i = 0; i < count; ++i) {
+        m_capacities[i] = outputs[i].capacity();
+    }
+
+    // Each stripe is a view into the image rows, so nothing is copied
+    auto encodeStripe = [&](int index) {
+        const int y = index * stripeHeight;
+        const int height = qMin(stripeHeight, image.height() - y);
+        const QImage stripe(image.constScanLine(y), image.width(), height,
+                            image.bytesPerLine(), image.format());
+        return m_workers[index]->encode(stripe, quality, outputs[index]);
+    };
+
+    // The calling thread takes the first stripe itself instead of idling
+    std::atomic<bool> ok{true};
+    QSemaphore done;
+    for (int i = 1; i < count; ++i) {
+        m_threadPool->start([&, i]() {
+            if (!encodeStripe(i)) {
+                ok = false;
+            }
+            done.release();
+        });
+    }
+    if (!encodeStripe(0)) {
+        ok = false;
+    }
+    done.acquire(count - 1);
+
+    for (int i = 0; i < count; ++i) {
+        if (outputs[i].capacity() != m_capacities[i]) {
+            bufferPool.noteAllocation();
+        }
+    }
+    if (!ok) {
+        qWarning() << "Failed to encode frame stripes";
+    }
+    return ok;
+}
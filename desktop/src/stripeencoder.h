@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#pragma once
+
+#include <QBuffer>
+#include <QByteArray>
+#include <QImage>
+#include <QImageWriter>
+#include <QVector>
+#include <memory>
+#include <vector>
+
+class QThreadPool;
+class FrameBufferPool;
+
+// Splits an image into horizontal stripes and compresses them as separate
+// JPEGs concurrently. Each stripe decodes on its own, so clients can draw
+// them at their offsets without any stitching on the server.
+class StripeEncoder
+{
+public:
+    explicit StripeEncoder(QThreadPool *threadPool);
+    ~StripeEncoder();
+
+    // Stripe heights are a multiple of the 16-line JPEG MCU so no stripe
+    // pays for a partially filled block row except the last
+    static int stripeHeight(int imageHeight, int stripeCount);
+    static int stripeCount(int imageHeight, int stripeHeight);
+
+    // Fills outputs[0..n) with the encoded stripes. Storage in outputs is
+    // reused across calls; growth is reported to the buffer pool.
+    bool encode(const QImage &image, int stripeHeight, int quality,
+                QVector<QByteArray> &outputs, FrameBufferPool &bufferPool);
+
+private:
+    struct Worker
+    {
+        Worker();
+        bool encode(const QImage &image, int quality, QByteArray &output);
+
+        QBuffer buffer;
+        QImageWriter writer;
+    };
+
+    QThreadPool *m_threadPool;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    QVector<qsizetype> m_capacities;
+};
@@ -0,0 +1,476 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#include "telemetry.h"
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QTimer>
+#include <QWebSocket>
+#include <QDebug>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+static const int MinIntervalMs = 100; // 10 Hz
+static const int MaxIntervalMs = 60000;
+static const int SectorSize = 512; // /proc/diskstats always counts 512-byte sectors
+
+struct ValueGroup
+{
+    const char *key;
+    const char *group;
+};
+
+// Which values a subscriber gets for each group it asks for
+static const ValueGroup ValueGroups[] = {
+    { "cpu", "cpu" },
+    { "cores", "cores" },
+    { "memTotalKb", "memory" },
+    { "memAvailableKb", "memory" },
+    { "swapTotalKb", "memory" },
+    { "swapFreeKb", "memory" },
+    { "diskReadBps", "disk" },
+    { "diskWriteBps", "disk" },
+    { "netRxBps", "network" },
+    { "netTxBps", "network" },
+    { "temperatureC", "temperature" },
+};
+
+static bool wantsKey(const QStringList &groups, const QString &key)
+{
+    if (groups.isEmpty()) {
+        return true;
+    }
+    for (const ValueGroup &entry : ValueGroups) {
+        if (key == QLatin1String(entry.key)) {
+            return groups.contains(QLatin1String(entry.group));
+        }
+    }
+    return false;
+}
+
+static double roundTo(double value, double step)
+{
+    return qRound64(value / step) * step;
+}
+
+static quint64 ratePerSecond(quint64 current, quint64 previous, double seconds)
+{
+    if (seconds <= 0 || current < previous) {
+        return 0;
+    }
+    return quint64((current - previous) / seconds);
+}
+
+Telemetry::Telemetry(QObject *parent)
+    : QObject(parent)
+    , m_timer(new QTimer(this))
+{
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &Telemetry::sample);
+    m_clock.start();
+}
+
+Telemetry::~Telemetry() = default;
+
+void Telemetry::handleRequest(const QJsonObject &request, QWebSocket *client)
+{
+    QString action = request["action"].toString();
+
+    if (action == "subscribe") {
+        subscribe(request, client);
+    } else if (action == "unsubscribe") {
+        clientDisconnected(client);
+    } else if (action == "sample") {
+        sendSnapshot(request, client);
+    } else if (action == "stats") {
+        sendStats(client);
+    }
+}
+
+void Telemetry::clientDisconnected(QWebSocket *client)
+{
+    for (int i = m_subscribers.size() - 1; i >= 0; --i) {
+        if (m_subscribers[i].client == client) {
+            m_subscribers.removeAt(i);
+        }
+    }
+    updateTimer();
+}
+
+void Telemetry::reattachClient(QWebSocket *from, QWebSocket *to)
+{
+    for (Subscriber &subscriber : m_subscribers) {
+        if (subscriber.client == from) {
+            // Start over with every value, deltas may have been lost
+            subscriber.client = to;
+            subscriber.sent = QJsonObject();
+            publish(subscriber);
+        }
+    }
+}
+
+void Telemetry::subscribe(const QJsonObject &request, QWebSocket *client)
+{
+    if (!openSources()) {
+        sendUnavailable(request, client);
+        return;
+    }
+
+    // Subscribing again replaces the previous subscription
+    clientDisconnected(client);
+
+    Subscriber subscriber;
+    subscriber.client = client;
+    subscriber.intervalMs = qBound(MinIntervalMs, request["intervalMs"].toInt(1000), MaxIntervalMs);
+    for (const QJsonValue &group : request["groups"].toArray()) {
+        subscriber.groups.append(group.toString());
+    }
+
+    // Take a fresh reading if the sampler has been idle, so the first
+    // message is not stale
+    if (!m_timer->isActive()) {
+        readSample();
+    }
+    subscriber.nextDue = m_clock.elapsed() + subscriber.intervalMs;
+    m_subscribers.append(subscriber);
+    publish(m_subscribers.last(), request["id"]);
+    updateTimer();
+}
+
+void Telemetry::sendSnapshot(const QJsonObject &request, QWebSocket *client)
+{
+    if (!openSources()) {
+        sendUnavailable(request, client);
+        return;
+    }
+    if (!m_timer->isActive()) {
+        readSample();
+    }
+
+    Subscriber once;
+    once.client = client;
+    publish(once, request["id"]);
+}
+
+void Telemetry::sendUnavailable(const QJsonObject &request, QWebSocket *client)
+{
+    QJsonObject response;
+    response["type"] = "telemetry";
+    response["id"] = request["id"];
+    response["status"] = "error";
+    response["message"] = "Telemetry is not available on this system";
+    client->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
+}
+
+void Telemetry::sendStats(QWebSocket *client)
+{
+    QJsonObject stats;
+    stats["subscribers"] = m_subscribers.size();
+    stats["intervalMs"] = m_timer->isActive() ? m_timer->interval() : 0;
+    stats["samples"] = m_samples;
+    stats["avgSampleUs"] = m_samples ? double(m_sampleNs) / m_samples / 1000.0 : 0.0;
+    // Share of one core spent sampling at the current rate
+    if (m_samples && m_timer->isActive()) {
+        const double sampleMs = double(m_sampleNs) / m_samples / 1e6;
+        stats["coreShare"] = sampleMs / m_timer->interval();
+    }
+
+    QJsonObject response;
+    response["type"] = "telemetry";
+    response["action"] = "stats";
+    response["data"] = stats;
+    client->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
+}
+
+void Telemetry::updateTimer()
+{
+    if (m_subscribers.isEmpty()) {
+        m_timer->stop();
+        return;
+    }
+
+    int interval = MaxIntervalMs;
+    for (const Subscriber &subscriber : std::as_const(m_subscribers)) {
+        interval = qMin(interval, subscriber.intervalMs);
+    }
+    if (!m_timer->isActive() || m_timer->interval() != interval) {
+        m_timer->start(interval);
+    }
+}
+
+void Telemetry::sample()
+{
+    readSample();
+
+    const qint64 now = m_clock.elapsed();
+    for (Subscriber &subscriber : m_subscribers) {
+        // Allow for timer jitter so a subscriber at the sampler's own rate
+        // is not skipped every other tick
+        if (now + m_timer->interval() / 2 < subscriber.nextDue || !subscriber.client->isValid()) {
+            continue;
+        }
+        subscriber.nextDue = qMax(subscriber.nextDue + subscriber.intervalMs, now);
+        publish(subscriber);
+    }
+}
+
+void Telemetry::publish(Subscriber &subscriber, const QJsonValue &id)
+{
+    QJsonObject delta;
+    for (auto it = m_values.constBegin(); it != m_values.constEnd(); ++it) {
+        if (wantsKey(subscriber.groups, it.key()) && subscriber.sent.value(it.key()) != it.value()) {
+            delta[it.key()] = it.value();
+            subscriber.sent[it.key()] = it.value();
+        }
+    }
+
+    // Periodic messages are skipped entirely when nothing changed
+    const bool reply = !id.isUndefined();
+    if (delta.isEmpty() && !reply) {
+        return;
+    }
+
+    QJsonObject message;
+    message["type"] = "telemetry";
+    message["action"] = "sample";
+    if (reply) {
+        message["id"] = id;
+    }
+    message["t"] = m_clock.elapsed();
+    message["data"] = delta;
+    subscriber.client->sendTextMessage(QJsonDocument(message).toJson(QJsonDocument::Compact));
+}
+
+bool Telemetry::openSources()
+{
+#ifdef Q_OS_LINUX
+    if (m_sourcesOpen) {
+        return true;
+    }
+
+    if (!m_stat.open("/proc/stat") || !m_meminfo.open("/proc/meminfo")) {
+        return false;
+    }
+    m_diskstats.open("/proc/diskstats");
+    m_netdev.open("/proc/net/dev");
+
+    // Stacked devices (device mapper, md) and virtual disks would count
+    // the same I/O more than once
+    const QStringList blockDevices = QDir("/sys/block").entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString &device : blockDevices) {
+        if (device.startsWith("loop") || device.startsWith("ram") || device.startsWith("zram")
+            || device.startsWith("dm-") || device.startsWith("md")) {
+            continue;
+        }
+        m_disks.append(device.toLatin1());
+    }
+
+    const QDir thermal("/sys/class/thermal");
+    const QStringList zones = thermal.entryList(QStringList() << "thermal_zone*", QDir::Dirs);
+    for (const QString &zone : zones) {
+        ProcFile file(thermal.filePath(zone + "/temp").toLocal8Bit());
+        if (file.isOpen()) {
+            m_thermalZones.push_back(std::move(file));
+        }
+    }
+
+    m_sourcesOpen = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Telemetry::readSample()
+{
+    m_sampling.start();
+
+    // Fill the older of the two counter sets; clearing keeps the per-core
+    // vectors' capacity, so reading the counters does not allocate
+    Counters &counters = m_counters[m_current];
+    const Counters &previous = m_counters[m_current ^ 1];
+    counters.cpuBusy = counters.cpuTotal = 0;
+    counters.coreBusy.clear();
+    counters.coreTotal.clear();
+    counters.diskReadSectors = counters.diskWriteSectors = 0;
+    counters.netRxBytes = counters.netTxBytes = 0;
+    counters.takenAt = m_clock.nsecsElapsed();
+
+    readCpu(counters);
+    readMemory();
+    readDisks(counters);
+    readNetwork(counters);
+    readTemperature();
+
+    if (previous.takenAt >= 0) {
+        const double seconds = (counters.takenAt - previous.takenAt) / 1e9;
+
+        const quint64 total = counters.cpuTotal - previous.cpuTotal;
+        if (total > 0) {
+            m_values["cpu"] = roundTo(100.0 * (counters.cpuBusy - previous.cpuBusy) / total, 0.1);
+        }
+
+        if (counters.coreTotal.size() == previous.coreTotal.size()) {
+            bool coresChanged = m_cores.size() != int(counters.coreTotal.size());
+            m_cores.resize(int(counters.coreTotal.size()));
+            for (size_t i = 0; i < counters.coreTotal.size(); ++i) {
+                const quint64 coreTotal = counters.coreTotal[i] - previous.coreTotal[i];
+                const double core = coreTotal ? qRound(100.0 * (counters.coreBusy[i] - previous.coreBusy[i]) / coreTotal) : 0;
+                coresChanged |= m_cores[int(i)] != core;
+                m_cores[int(i)] = core;
+            }
+            // Only build a new array when a core's load moved
+            if (coresChanged) {
+                QJsonArray cores;
+                for (double core : std::as_const(m_cores)) {
+                    cores.append(core);
+                }
+                m_values["cores"] = cores;
+            }
+        }
+
+        m_values["diskReadBps"] = qint64(ratePerSecond(counters.diskReadSectors, previous.diskReadSectors, seconds) * SectorSize);
+        m_values["diskWriteBps"] = qint64(ratePerSecond(counters.diskWriteSectors, previous.diskWriteSectors, seconds) * SectorSize);
+        m_values["netRxBps"] = qint64(ratePerSecond(counters.netRxBytes, previous.netRxBytes, seconds));
+        m_values["netTxBps"] = qint64(ratePerSecond(counters.netTxBytes, previous.netTxBytes, seconds));
+    }
+
+    m_current ^= 1;
+
+    ++m_samples;
+    m_sampleNs += m_sampling.nsecsElapsed();
+}
+
+void Telemetry::readCpu(Counters &counters)
+{
+    const char *text = m_stat.read();
+    if (!text) {
+        return;
+    }
+
+    // "cpu  user nice system idle iowait irq softirq steal ..." followed by
+    // one "cpuN" line per core
+    for (const char *line = text; line && strncmp(line, "cpu", 3) == 0; line = ProcFile::nextLine(line)) {
+        const char *cursor = ProcFile::skipFields(line, 1);
+        quint64 fields[8] = {};
+        for (quint64 &field : fields) {
+            field = ProcFile::parseNumber(cursor);
+        }
+        const quint64 idle = fields[3] + fields[4];
+        quint64 total = 0;
+        for (quint64 field : fields) {
+            total += field;
+        }
+
+        if (line[3] == ' ') {
+            counters.cpuBusy = total - idle;
+            counters.cpuTotal = total;
+        } else {
+            counters.coreBusy.push_back(total - idle);
+            counters.coreTotal.push_back(total);
+        }
+    }
+}
+
+void Telemetry::readMemory()
+{
+    const char *text = m_meminfo.read();
+    if (!text) {
+        return;
+    }
+
+    static const struct {
+        const char *prefix;
+        const char *key;
+    } Fields[] = {
+        { "MemTotal:", "memTotalKb" },
+        { "MemAvailable:", "memAvailableKb" },
+        { "SwapTotal:", "swapTotalKb" },
+        { "SwapFree:", "swapFreeKb" },
+    };
+
+    for (const auto &field : Fields) {
+        const char *cursor = ProcFile::findLine(text, field.prefix);
+        if (cursor) {
+            cursor += strlen(field.prefix);
+            // Memory moves constantly; megabyte steps keep deltas meaningful
+            const qint64 kb = qint64(ProcFile::parseNumber(cursor));
+            m_values[QLatin1String(field.key)] = kb / 1024 * 1024;
+        }
+    }
+}
+
+void Telemetry::readDisks(Counters &counters)
+{
+    const char *text = m_diskstats.read();
+    if (!text) {
+        return;
+    }
+
+    // "major minor name reads merged sectorsRead msReading writes merged sectorsWritten ..."
+    for (const char *line = text; line && *line; line = ProcFile::nextLine(line)) {
+        const char *name = ProcFile::skipSpaces(ProcFile::skipFields(line, 2));
+        const char *nameEnd = ProcFile::skipFields(name, 1);
+        const int nameLength = int(nameEnd - name);
+
+        bool wholeDisk = false;
+        for (const QByteArray &disk : std::as_const(m_disks)) {
+            if (disk.size() == nameLength && memcmp(disk.constData(), name, nameLength) == 0) {
+                wholeDisk = true;
+                break;
+            }
+        }
+        if (!wholeDisk) {
+            continue;
+        }
+
+        const char *cursor = ProcFile::skipFields(nameEnd, 2);
+        counters.diskReadSectors += ProcFile::parseNumber(cursor);
+        cursor = ProcFile::skipFields(cursor, 3);
+        counters.diskWriteSectors += ProcFile::parseNumber(cursor);
+    }
+}
+
+void Telemetry::readNetwork(Counters &counters)
+{
+    const char *text = m_netdev.read();
+    if (!text) {
+        return;
+    }
+
+    // Two header lines, then "  name: rxBytes rxPackets errs drop fifo frame
+    // compressed multicast txBytes ..."
+    const char *line = ProcFile::nextLine(text);
+    for (line = line ? ProcFile::nextLine(line) : nullptr; line && *line; line = ProcFile::nextLine(line)) {
+        const char *name = ProcFile::skipSpaces(line);
+        const char *colon = strchr(name, ':');
+        if (!colon) {
+            continue;
+        }
+        if (colon - name == 2 && strncmp(name, "lo", 2) == 0) {
+            continue;
+        }
+
+        const char *cursor = colon + 1;
+        counters.netRxBytes += ProcFile::parseNumber(cursor);
+        cursor = ProcFile::skipFields(cursor, 7);
+        counters.netTxBytes += ProcFile::parseNumber(cursor);
+    }
+}
+
+void Telemetry::readTemperature()
+{
+    // Report the hottest zone; millidegrees in sysfs
+    qint64 hottest = std::numeric_limits<qint64>::min();
+    for (ProcFile &zone : m_thermalZones) {
+        const char *text = zone.read();
+        if (text) {
+            hottest = qMax(hottest, ProcFile::parseSigned(text));
+        }
+    }
+    if (hottest != std::numeric_limits<qint64>::min()) {
+        m_values["temperatureC"] = roundTo(hottest / 1000.0, 0.5);
+    }
+}
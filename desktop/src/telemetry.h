@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#pragma once
+
+#include <QObject>
+#include <QByteArrayList>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QList>
+#include <QStringList>
+#include <QVector>
+#include <vector>
+#include "procfile.h"
+
+class QTimer;
+class QWebSocket;
+
+// Live CPU, memory, disk, network and temperature readings from /proc and
+// /sys. One sampler serves all subscribers at the fastest requested rate;
+// each subscriber is sent, at its own rate, only the values that changed
+// since its previous message.
+class Telemetry : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit Telemetry(QObject *parent = nullptr);
+    ~Telemetry();
+
+    void handleRequest(const QJsonObject &request, QWebSocket *client);
+    void clientDisconnected(QWebSocket *client);
+    void reattachClient(QWebSocket *from, QWebSocket *to);
+
+private slots:
+    void sample();
+
+private:
+    struct Subscriber
+    {
+        QWebSocket *client = nullptr;
+        int intervalMs = 1000;
+        qint64 nextDue = 0;
+        QStringList groups; // Empty means every group
+        QJsonObject sent;   // Values as of the last message
+    };
+
+    // Monotonic counters from one sample, for computing rates
+    struct Counters
+    {
+        quint64 cpuBusy = 0;
+        quint64 cpuTotal = 0;
+        std::vector<quint64> coreBusy;
+        std::vector<quint64> coreTotal;
+        quint64 diskReadSectors = 0;
+        quint64 diskWriteSectors = 0;
+        quint64 netRxBytes = 0;
+        quint64 netTxBytes = 0;
+        qint64 takenAt = -1;
+    };
+
+    void subscribe(const QJsonObject &request, QWebSocket *client);
+    void sendSnapshot(const QJsonObject &request, QWebSocket *client);
+    void sendStats(QWebSocket *client);
+    void sendUnavailable(const QJsonObject &request, QWebSocket *client);
+    void publish(Subscriber &subscriber, const QJsonValue &id = QJsonValue(QJsonValue::Undefined));
+    void updateTimer();
+
+    bool openSources();
+    void readSample();
+    void readCpu(Counters &counters);
+    void readMemory();
+    void readDisks(Counters &counters);
+    void readNetwork(Counters &counters);
+    void readTemperature();
+
+    QTimer *m_timer;
+    QList<Subscriber> m_subscribers;
+    QElapsedTimer m_clock;
+
+    bool m_sourcesOpen = false;
+    ProcFile m_stat;
+    ProcFile m_meminfo;
+    ProcFile m_diskstats;
+    ProcFile m_netdev;
+    std::vector<ProcFile> m_thermalZones;
+    QByteArrayList m_disks; // Whole disks; partitions would count twice
+
+    // The latest sample and the one before it, filled alternately
+    Counters m_counters[2];
+    int m_current = 0;
+    QJsonObject m_values;
+    QVector<double> m_cores;
+
+    // Cost of sampling, reported by telemetry/stats
+    qint64 m_samples = 0;
+    qint64 m_sampleNs = 0;
+    QElapsedTimer m_sampling;
+};
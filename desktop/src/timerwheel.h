@@ -0,0 +1,131 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#pragma once
+
+#include <QtGlobal>
+#include <array>
+#include <limits>
+#include <vector>
+
+// Hierarchical timer wheel: four levels of 64 slots, each level's slot
+// spanning a whole turn of the level below. Scheduling and expiry are
+// constant time however many timers are pending; entries further out are
+// moved down a level each time the level below wraps around.
+//
+// Time is counted in ticks of the caller's choosing. Entries up to 64^4
+// ticks ahead are kept exactly; later ones are clamped. Not thread safe.
+class TimerWheel
+{
+public:
+    static const quint64 NoTick = std::numeric_limits<quint64>::max();
+
+    explicit TimerWheel(quint64 now = 0)
+        : m_now(now)
+    {
+    }
+
+    quint64 now() const { return m_now; }
+    bool isEmpty() const { return m_count == 0; }
+
+    // Only allowed while empty, to skip idle time without walking it
+    void reset(quint64 now)
+    {
+        Q_ASSERT(m_count == 0);
+        m_now = now;
+    }
+
+    // An entry due now or earlier fires on the next tick
+    void schedule(quint32 id, quint64 dueTick)
+    {
+        insert({ id, qMax(dueTick, m_now + 1) });
+        ++m_count;
+    }
+
+    // Moves time forward to tick, calling expired(id, dueTick) for every
+    // entry that comes due. The callback may schedule new entries.
+    template<typename Callback>
+    void advance(quint64 tick, Callback &&expired)
+    {
+        std::vector<Entry> due;
+        while (m_now < tick && m_count > 0) {
+            ++m_now;
+            cascade();
+
+            due.clear();
+            due.swap(m_slots[0][m_now & SlotMask]);
+            m_count -= due.size();
+            for (const Entry &entry : due) {
+                expired(entry.id, entry.due);
+            }
+        }
+        if (m_count == 0 && m_now < tick) {
+            m_now = tick;
+        }
+    }
+
+    // Whether an entry is known to be due at tick, for ticks up to one turn
+    // of the lowest level ahead
+    bool hasDue(quint64 tick) const { return !m_slots[0][tick & SlotMask].empty(); }
+
+    // The first tick at which advance() may expire something or has to
+    // move entries down a level; NoTick when empty
+    quint64 nextTick() const
+    {
+        if (m_count == 0) {
+            return NoTick;
+        }
+        for (quint64 tick = m_now + 1;; ++tick) {
+            if ((tick & SlotMask) == 0 || !m_slots[0][tick & SlotMask].empty()) {
+                return tick;
+            }
+        }
+    }
+
+private:
+    static const int SlotBits = 6;
+    static const quint64 SlotMask = (1 << SlotBits) - 1;
+    static const int Levels = 4;
+
+    struct Entry
+    {
+        quint32 id;
+        quint64 due;
+    };
+
+    void insert(Entry entry)
+    {
+        const quint64 maxDelta = (quint64(1) << (SlotBits * Levels)) - 1;
+        entry.due = qMin(entry.due, m_now + maxDelta);
+        const quint64 delta = entry.due - m_now;
+
+        int level = 0;
+        while (level < Levels - 1 && delta >> (SlotBits * (level + 1))) {
+            ++level;
+        }
+        m_slots[level][(entry.due >> (SlotBits * level)) & SlotMask].push_back(entry);
+    }
+
+    // At each wrap of a level, the next slot of the level above is spread
+    // over the levels below
+    void cascade()
+    {
+        int top = 0;
+        while (top < Levels - 1 && ((m_now >> (SlotBits * top)) & SlotMask) == 0) {
+            ++top;
+        }
+        // Higher levels first, so their entries can land in lower slots
+        // that are about to be cascaded too
+        for (int level = top; level >= 1; --level) {
+            std::vector<Entry> entries;
+            entries.swap(m_slots[level][(m_now >> (SlotBits * level)) & SlotMask]);
+            for (const Entry &entry : entries) {
+                insert(entry);
+            }
+        }
+    }
+
+    std::array<std::array<std::vector<Entry>, 1 << SlotBits>, Levels> m_slots;
+    quint64 m_now;
+    size_t m_count = 0;
+};
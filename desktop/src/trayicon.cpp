@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#include "trayicon.h"
+#include <QApplication>
+#include <QMenu>
+#include <QMessageBox>
+#include <QSystemTrayIcon>
+
+std::unique_ptr<QCoreApplication> TrayIcon::createApplication(int &argc, char *argv[])
+{
+    auto app = std::make_unique<QApplication>(argc, argv);
+    app->setQuitOnLastWindowClosed(false);
+    return app;
+}
+
+bool TrayIcon::isAvailable()
+{
+    return QSystemTrayIcon::isSystemTrayAvailable();
+}
+
+void TrayIcon::showError(const QString &title, const QString &message)
+{
+    QMessageBox::critical(nullptr, title, message);
+}
+
+TrayIcon::TrayIcon(quint16 port, QObject *parent)
+    : QObject(parent)
+    , m_menu(std::make_unique<QMenu>())
+    , m_icon(new QSystemTrayIcon(this))
+{
+    m_icon->setIcon(QIcon::fromTheme("network-server"));
+    m_icon->setToolTip("PC Remote Server - Running");
+
+    QAction *statusAction = m_menu->addAction(QString("Server: Running on port %1").arg(port));
+    statusAction->setEnabled(false);
+    m_menu->addSeparator();
+    QAction *quitAction = m_menu->addAction("Quit");
+
+    connect(quitAction, &QAction::triggered, qApp, &QCoreApplication::quit);
+
+    m_icon->setContextMenu(m_menu.get());
+    m_icon->show();
+    m_icon->showMessage("PC Remote Server",
+                        QString("Server is running on port %1").arg(port),
+                        QSystemTrayIcon::Information, 3000);
+}
+
+TrayIcon::~TrayIcon() = default;
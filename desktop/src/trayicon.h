@@ -0,0 +1,33 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <memory>
+
+class QCoreApplication;
+class QMenu;
+class QSystemTrayIcon;
+
+// The system tray front end. It is the only part of the server that needs
+// Qt Widgets, so it is left out of builds without PCREMOTE_TRAY, and
+// headless deployments built that way never load them.
+class TrayIcon : public QObject
+{
+    Q_OBJECT
+
+public:
+    // The tray needs a QApplication rather than a QGuiApplication
+    static std::unique_ptr<QCoreApplication> createApplication(int &argc, char *argv[]);
+    static bool isAvailable();
+    static void showError(const QString &title, const QString &message);
+
+    explicit TrayIcon(quint16 port, QObject *parent = nullptr);
+    ~TrayIcon();
+
+private:
+    std::unique_ptr<QMenu> m_menu;
+    QSystemTrayIcon *m_icon;
+};
@@ -0,0 +1,532 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#include "windowtracker.h"
+#include <QBuffer>
+#include <QGuiApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QScreen>
+#include <QSet>
+#include <QSocketNotifier>
+#include <QWebSocket>
+#include <QtMath>
+#include <QDebug>
+
+#ifdef HAVE_X11
+#include <X11/Xatom.h>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#endif
+
+static const int DefaultIconSize = 32;
+static const int MaxIconSize = 256;
+
+struct WindowTracker::X11State
+{
+#ifdef HAVE_X11
+    // A private connection, like the damage monitor's, so events selected
+    // here do not reach Qt
+    Display *display = nullptr;
+    ::Window root = 0;
+    Atom clientList = 0;
+    Atom activeWindow = 0;
+    Atom netWmName = 0;
+    Atom netWmIcon = 0;
+    Atom utf8String = 0;
+#endif
+};
+
+#ifdef HAVE_X11
+
+static Display *s_display = nullptr;
+static XErrorHandler s_previousHandler = nullptr;
+
+// A window can be destroyed between learning about it and asking about it,
+// so errors on this connection are expected and ignored. Errors on other
+// connections go to the handler that was installed before.
+static int handleXError(Display *display, XErrorEvent *event)
+{
+    if (display == s_display) {
+        return 0;
+    }
+    return s_previousHandler ? s_previousHandler(display, event) : 0;
+}
+
+static qreal devicePixelRatio()
+{
+    QScreen *primary = QGuiApplication::primaryScreen();
+    return primary ? primary->devicePixelRatio() : 1.0;
+}
+
+// Reads a property of 8-bit items, such as a title
+static QByteArray readTextProperty(Display *display, ::Window window, Atom property, Atom type)
+{
+    Atom actualType = 0;
+    int format = 0;
+    unsigned long count = 0;
+    unsigned long remaining = 0;
+    unsigned char *data = nullptr;
+    QByteArray text;
+    if (XGetWindowProperty(display, window, property, 0, 1024, False, type,
+                           &actualType, &format, &count, &remaining, &data) == Success
+        && data && format == 8) {
+        text = QByteArray(reinterpret_cast<const char *>(data), int(count));
+    }
+    if (data) {
+        XFree(data);
+    }
+    return text;
+}
+
+#endif // HAVE_X11
+
+WindowTracker::WindowTracker(QObject *parent)
+    : QObject(parent)
+    , m_x11(std::make_unique<X11State>())
+{
+    if (!initX11()) {
+        qDebug() << "Window list unavailable, it needs an X11 session";
+    }
+}
+
+WindowTracker::~WindowTracker()
+{
+#ifdef HAVE_X11
+    if (m_x11->display) {
+        XSetErrorHandler(s_previousHandler);
+        s_display = nullptr;
+        XCloseDisplay(m_x11->display);
+    }
+#endif
+}
+
+bool WindowTracker::isAvailable() const
+{
+    return m_notifier != nullptr;
+}
+
+bool WindowTracker::initX11()
+{
+#ifdef HAVE_X11
+    // Under Wayland an X connection would only see XWayland clients
+    if (QGuiApplication::platformName() != QLatin1String("xcb")) {
+        return false;
+    }
+
+    Display *display = XOpenDisplay(nullptr);
+    if (!display) {
+        return false;
+    }
+
+    m_x11->display = display;
+    m_x11->root = DefaultRootWindow(display);
+    m_x11->clientList = XInternAtom(display, "_NET_CLIENT_LIST", False);
+    m_x11->activeWindow = XInternAtom(display, "_NET_ACTIVE_WINDOW", False);
+    m_x11->netWmName = XInternAtom(display, "_NET_WM_NAME", False);
+    m_x11->netWmIcon = XInternAtom(display, "_NET_WM_ICON", False);
+    m_x11->utf8String = XInternAtom(display, "UTF8_STRING", False);
+
+    s_display = display;
+    s_previousHandler = XSetErrorHandler(handleXError);
+
+    XSelectInput(display, m_x11->root, PropertyChangeMask);
+    readClientList();
+    XFlush(display);
+
+    m_notifier = new QSocketNotifier(ConnectionNumber(display), QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &WindowTracker::processEvents);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void WindowTracker::processEvents()
+{
+#ifdef HAVE_X11
+    Display *display = m_x11->display;
+    bool clientListChanged = false;
+    QSet<quint64> moved;
+
+    while (XPending(display)) {
+        XEvent event;
+        XNextEvent(display, &event);
+        ++m_events;
+
+        if (event.type == PropertyNotify) {
+            const XPropertyEvent &property = event.xproperty;
+            if (property.window == m_x11->root) {
+                if (property.atom == m_x11->clientList) {
+                    clientListChanged = true;
+                } else if (property.atom == m_x11->activeWindow) {
+                    m_activeStale = true;
+                }
+                continue;
+            }
+            auto it = m_windows.find(property.window);
+            if (it == m_windows.end()) {
+                continue;
+            }
+            if (property.atom == m_x11->netWmName || property.atom == XA_WM_NAME) {
+                it->titleStale = true;
+            } else if (property.atom == m_x11->netWmIcon) {
+                it->iconStale = true;
+            }
+        } else if (event.type == ConfigureNotify || event.type == MapNotify || event.type == UnmapNotify) {
+            // Window managers move the frame, not the client window, and
+            // send a synthetic ConfigureNotify for it
+            auto it = m_windows.find(event.xany.window);
+            if (it != m_windows.end()) {
+                it->geometryStale = true;
+                moved.insert(it->id);
+            }
+        }
+    }
+
+    if (clientListChanged) {
+        readClientList();
+        XFlush(display);
+    }
+
+    // The round trips above may have queued events the socket notifier will
+    // never see, so make sure they are picked up
+    if (XEventsQueued(display, QueuedAlready) > 0) {
+        QMetaObject::invokeMethod(this, &WindowTracker::processEvents, Qt::QueuedConnection);
+    }
+
+    for (quint64 id : std::as_const(moved)) {
+        if (m_windows.contains(id)) {
+            emit geometryChanged(id);
+        }
+    }
+#endif
+}
+
+void WindowTracker::readClientList()
+{
+#ifdef HAVE_X11
+    Atom type = 0;
+    int format = 0;
+    unsigned long count = 0;
+    unsigned long remaining = 0;
+    unsigned char *data = nullptr;
+    ++m_roundTrips;
+
+    QList<quint64> order;
+    if (XGetWindowProperty(m_x11->display, m_x11->root, m_x11->clientList, 0, 65536, False, XA_WINDOW,
+                           &type, &format, &count, &remaining, &data) == Success
+        && data && format == 32) {
+        // Items of format 32 are handed out as longs
+        const auto *ids = reinterpret_cast<const unsigned long *>(data);
+        for (unsigned long i = 0; i < count; ++i) {
+            order.append(ids[i]);
+        }
+    }
+    if (data) {
+        XFree(data);
+    }
+
+    const QSet<quint64> current(order.begin(), order.end());
+    for (quint64 id : std::as_const(m_order)) {
+        if (!current.contains(id)) {
+            m_windows.remove(id);
+            emit windowClosed(id);
+        }
+    }
+    for (quint64 id : std::as_const(order)) {
+        if (!m_windows.contains(id)) {
+            addWindow(id);
+        }
+    }
+    m_order = order;
+#endif
+}
+
+void WindowTracker::addWindow(quint64 id)
+{
+#ifdef HAVE_X11
+    Window window;
+    window.id = id;
+
+    XSelectInput(m_x11->display, id, PropertyChangeMask | StructureNotifyMask);
+
+    // The class never changes, so it is read once
+    XClassHint hint = {};
+    ++m_roundTrips;
+    if (XGetClassHint(m_x11->display, id, &hint)) {
+        window.appClass = QString::fromLocal8Bit(hint.res_class);
+        XFree(hint.res_name);
+        XFree(hint.res_class);
+    }
+    m_windows.insert(id, window);
+#else
+    Q_UNUSED(id)
+#endif
+}
+
+bool WindowTracker::contains(quint64 id) const
+{
+    return m_windows.contains(id);
+}
+
+QRect WindowTracker::geometry(quint64 id)
+{
+    auto it = m_windows.find(id);
+    if (it == m_windows.end()) {
+        return QRect();
+    }
+    if (it->geometryStale) {
+        readGeometry(*it);
+    }
+    return it->viewable ? it->geometry : QRect();
+}
+
+void WindowTracker::refresh(Window &window, bool withIcon)
+{
+    if (window.titleStale) {
+        readTitle(window);
+    }
+    if (window.geometryStale) {
+        readGeometry(window);
+    }
+    if (withIcon && window.iconStale) {
+        readIcon(window);
+    }
+}
+
+void WindowTracker::readTitle(Window &window)
+{
+#ifdef HAVE_X11
+    ++m_roundTrips;
+    QByteArray title = readTextProperty(m_x11->display, window.id, m_x11->netWmName, m_x11->utf8String);
+    if (!title.isEmpty()) {
+        window.title = QString::fromUtf8(title);
+    } else {
+        // Old clients only set the ICCCM name
+        ++m_roundTrips;
+        title = readTextProperty(m_x11->display, window.id, XA_WM_NAME, AnyPropertyType);
+        window.title = QString::fromLocal8Bit(title);
+    }
+#endif
+    window.titleStale = false;
+}
+
+void WindowTracker::readGeometry(Window &window)
+{
+#ifdef HAVE_X11
+    window.geometry = QRect();
+    window.viewable = false;
+
+    XWindowAttributes attributes;
+    ++m_roundTrips;
+    if (XGetWindowAttributes(m_x11->display, window.id, &attributes)) {
+        int x = 0;
+        int y = 0;
+        ::Window child = 0;
+        ++m_roundTrips;
+        if (XTranslateCoordinates(m_x11->display, window.id, m_x11->root, 0, 0, &x, &y, &child)) {
+            // X reports device pixels; screens are laid out in logical pixels
+            const qreal ratio = devicePixelRatio();
+            window.geometry = QRect(qFloor(x / ratio), qFloor(y / ratio),
+                                    qCeil(attributes.width / ratio), qCeil(attributes.height / ratio));
+            window.viewable = attributes.map_state == IsViewable;
+        }
+    }
+#endif
+    window.geometryStale = false;
+}
+
+void WindowTracker::readIcon(Window &window)
+{
+#ifdef HAVE_X11
+    window.icon = QImage();
+    window.iconPng.clear();
+    window.iconPngSize = 0;
+
+    Atom type = 0;
+    int format = 0;
+    unsigned long count = 0;
+    unsigned long remaining = 0;
+    unsigned char *data = nullptr;
+    ++m_roundTrips;
+    if (XGetWindowProperty(m_x11->display, window.id, m_x11->netWmIcon, 0, 1 << 20, False, XA_CARDINAL,
+                           &type, &format, &count, &remaining, &data) == Success
+        && data && format == 32) {
+        // A list of icons, each its width and height followed by that many
+        // ARGB pixels; the largest is kept and scaled down as needed
+        const auto *items = reinterpret_cast<const unsigned long *>(data);
+        unsigned long best = 0;
+        unsigned long bestArea = 0;
+        for (unsigned long i = 0; i + 2 <= count;) {
+            const unsigned long width = items[i];
+            const unsigned long height = items[i + 1];
+            const unsigned long area = width * height;
+            if (width == 0 || height == 0 || width > 4096 || height > 4096 || area > count - i - 2) {
+                break;
+            }
+            if (area > bestArea) {
+                best = i;
+                bestArea = area;
+            }
+            i += 2 + area;
+        }
+
+        if (bestArea > 0) {
+            const int width = int(items[best]);
+            const int height = int(items[best + 1]);
+            const unsigned long *pixels = items + best + 2;
+            QImage icon(width, height, QImage::Format_ARGB32);
+            for (int y = 0; y < height; ++y) {
+                auto *line = reinterpret_cast<quint32 *>(icon.scanLine(y));
+                for (int x = 0; x < width; ++x) {
+                    line[x] = quint32(pixels[y * width + x]);
+                }
+            }
+            window.icon = icon;
+        }
+    }
+    if (data) {
+        XFree(data);
+    }
+#endif
+    window.iconStale = false;
+}
+
+QByteArray WindowTracker::iconPng(Window &window, int size)
+{
+    if (window.iconStale) {
+        readIcon(window);
+    }
+    if (window.icon.isNull()) {
+        return QByteArray();
+    }
+    if (window.iconPngSize != size) {
+        const QImage scaled = qMax(window.icon.width(), window.icon.height()) > size
+            ? window.icon.scaled(size, size, Qt::KeepAspectRatio, Qt::SmoothTransformation)
+            : window.icon;
+        window.iconPng.clear();
+        QBuffer buffer(&window.iconPng);
+        buffer.open(QIODevice::WriteOnly);
+        scaled.save(&buffer, "PNG");
+        window.iconPngSize = size;
+    }
+    return window.iconPng;
+}
+
+quint64 WindowTracker::activeWindow()
+{
+#ifdef HAVE_X11
+    if (m_activeStale) {
+        m_active = 0;
+        Atom type = 0;
+        int format = 0;
+        unsigned long count = 0;
+        unsigned long remaining = 0;
+        unsigned char *data = nullptr;
+        ++m_roundTrips;
+        if (XGetWindowProperty(m_x11->display, m_x11->root, m_x11->activeWindow, 0, 1, False, XA_WINDOW,
+                               &type, &format, &count, &remaining, &data) == Success
+            && data && format == 32 && count == 1) {
+            m_active = *reinterpret_cast<const unsigned long *>(data);
+        }
+        if (data) {
+            XFree(data);
+        }
+        m_activeStale = false;
+    }
+#endif
+    return m_active;
+}
+
+void WindowTracker::handleRequest(const QJsonObject &request, QWebSocket *client)
+{
+    QString action = request["action"].toString();
+
+    if (!isAvailable()) {
+        sendUnavailable(request, client);
+    } else if (action == "list") {
+        sendList(request, client);
+    } else if (action == "stats") {
+        sendStats(client);
+    } else {
+        QJsonObject response;
+        response["type"] = "window";
+        response["action"] = action;
+        response["id"] = request["id"];
+        response["status"] = "error";
+        response["message"] = "Unknown window action";
+        client->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
+    }
+}
+
+void WindowTracker::sendList(const QJsonObject &request, QWebSocket *client)
+{
+    // Icons are opt-in; encoded ones are kept until the icon changes
+    const bool icons = request["icons"].toBool();
+    const int iconSize = qBound(16, request["iconSize"].toInt(DefaultIconSize), MaxIconSize);
+    const quint64 active = activeWindow();
+    ++m_lists;
+
+    QJsonArray windows;
+    for (quint64 id : std::as_const(m_order)) {
+        auto it = m_windows.find(id);
+        if (it == m_windows.end()) {
+            continue;
+        }
+        Window &window = *it;
+        refresh(window, false);
+
+        QJsonObject info;
+        info["window"] = double(id);
+        info["title"] = window.title;
+        info["class"] = window.appClass;
+        info["x"] = window.geometry.x();
+        info["y"] = window.geometry.y();
+        info["width"] = window.geometry.width();
+        info["height"] = window.geometry.height();
+        info["visible"] = window.viewable;
+        info["active"] = id == active;
+        if (icons) {
+            const QByteArray png = iconPng(window, iconSize);
+            if (!png.isEmpty()) {
+                info["icon"] = QString::fromLatin1(png.toBase64());
+            }
+        }
+        windows.append(info);
+    }
+
+    QJsonObject response;
+    response["type"] = "window";
+    response["action"] = "list";
+    response["id"] = request["id"];
+    response["status"] = "success";
+    response["windows"] = windows;
+    client->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
+}
+
+void WindowTracker::sendStats(QWebSocket *client)
+{
+    QJsonObject stats;
+    stats["windows"] = m_windows.size();
+    stats["events"] = qint64(m_events);
+    stats["lists"] = qint64(m_lists);
+    // Requests that waited for a reply from the X server
+    stats["roundTrips"] = qint64(m_roundTrips);
+
+    QJsonObject response;
+    response["type"] = "window";
+    response["action"] = "stats";
+    response["data"] = stats;
+    client->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
+}
+
+void WindowTracker::sendUnavailable(const QJsonObject &request, QWebSocket *client)
+{
+    QJsonObject response;
+    response["type"] = "window";
+    response["id"] = request["id"];
+    response["status"] = "error";
+    response["message"] = "Window list is only available in an X11 session";
+    client->sendTextMessage(QJsonDocument(response).toJson(QJsonDocument::Compact));
+}
@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 Multi-Function PC Remote Contributors
+
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QImage>
+#include <QJsonObject>
+#include <QList>
+#include <QRect>
+#include <QString>
+#include <memory>
+
+class QSocketNotifier;
+class QWebSocket;
+
+// Top-level application windows as the window manager lists them in
+// _NET_CLIENT_LIST. Titles, geometry and icons are cached; property and
+// configure events only mark them stale, and they are read again the next
+// time they are asked for, so listing windows that did not change costs
+// no round trips to the X server. Only available on X11.
+class WindowTracker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit WindowTracker(QObject *parent = nullptr);
+    ~WindowTracker();
+
+    bool isAvailable() const;
+
+    void handleRequest(const QJsonObject &request, QWebSocket *client);
+
+    bool contains(quint64 id) const;
+    // Position of the window's contents in global logical coordinates;
+    // null once the window is gone
+    QRect geometry(quint64 id);
+
+signals:
+    // Moved, resized or mapped
+    void geometryChanged(quint64 id);
+    void windowClosed(quint64 id);
+
+private slots:
+    void processEvents();
+
+private:
+    struct X11State;
+
+    struct Window
+    {
+        quint64 id = 0;
+        QString title;
+        QString appClass;
+        QRect geometry;
+        bool viewable = false;
+        QImage icon;             // Largest size the window offers
+        QByteArray iconPng;      // Scaled to iconPngSize
+        int iconPngSize = 0;
+        bool titleStale = true;
+        bool geometryStale = true;
+        bool iconStale = true;
+    };
+
+    bool initX11();
+    void readClientList();
+    void addWindow(quint64 id);
+    void refresh(Window &window, bool withIcon);
+    void readTitle(Window &window);
+    void readGeometry(Window &window);
+    void readIcon(Window &window);
+    QByteArray iconPng(Window &window, int size);
+    quint64 activeWindow();
+    void sendList(const QJsonObject &request, QWebSocket *client);
+    void sendStats(QWebSocket *client);
+    void sendUnavailable(const QJsonObject &request, QWebSocket *client);
+
+    std::unique_ptr<X11State> m_x11;
+    QSocketNotifier *m_notifier = nullptr;
+
+    // In _NET_CLIENT_LIST order, which is the order windows were mapped in
+    QList<quint64> m_order;
+    QHash<quint64, Window> m_windows;
+    quint64 m_active = 0;
+    bool m_activeStale = true;
+
+    // Replies to the X server, to show what the cache saves
+    quint64 m_events = 0;
+    quint64 m_roundTrips = 0;
+    quint64 m_lists = 0;
+};
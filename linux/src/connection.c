@@ -3,7 +3,22 @@
 
 #include "connection.h"
 #include <libsoup/soup.h>
-#include <json-glib/json-glib.h>
+#include <string.h>
+
+#define DEFAULT_TIMEOUT_MS 10000
+
+/* Screen frames are large and only needed by the screen view's decoder
+ * thread, so they are recognised by prefix instead of being parsed here */
+static const char frame_prefix[] = "{\"type\":\"screen\",\"action\":\"frame\"";
+static const char refine_prefix[] = "{\"type\":\"screen\",\"action\":\"refine\"";
+static const char update_prefix[] = "{\"type\":\"screen\",\"action\":\"update\"";
+
+typedef struct
+{
+    gint64 id;
+    GTask *task;
+    guint timeout_source;
+} PendingRequest;
 
 struct _PcRemoteConnection
 {
@@ -12,32 +27,148 @@ struct _PcRemoteConnection
     SoupSession *session;
     SoupWebsocketConnection *websocket;
     gboolean connected;
+    
+    /* Ids only need to be unique per connection; a counter cannot collide
+     * the way timestamps do when commands are sent in a burst */
+    gint64 next_id;
+    GHashTable *pending;
+    
+    /* Reused for every message rather than created per command */
+    JsonBuilder *builder;
+    JsonGenerator *generator;
+    JsonParser *parser;
 };
 
+enum {
+    SIGNAL_MESSAGE,
+    SIGNAL_FRAME,
+    N_SIGNALS
+};
+
+static guint signals[N_SIGNALS];
+
 G_DEFINE_TYPE(PcRemoteConnection, pc_remote_connection, G_TYPE_OBJECT)
 
+static void
+pending_request_free(PendingRequest *request)
+{
+    if (request->timeout_source)
+        g_source_remove(request->timeout_source);
+    g_clear_object(&request->task);
+    g_free(request);
+}
+
+static GHashTable *
+pending_table_new(void)
+{
+    /* Keyed by the id inside each request, which the table owns */
+    return g_hash_table_new_full(g_int64_hash, g_int64_equal, NULL,
+                                 (GDestroyNotify) pending_request_free);
+}
+
+static void
+fail_pending_requests(PcRemoteConnection *self, GQuark domain, int code, const char *message)
+{
+    GHashTableIter iter;
+    gpointer value;
+    
+    /* A completion callback may send a new request, so the failed ones are
+     * taken out of self->pending before any callback can run */
+    g_autoptr(GHashTable) failed = self->pending;
+    self->pending = pending_table_new();
+    
+    g_hash_table_iter_init(&iter, failed);
+    while (g_hash_table_iter_next(&iter, NULL, &value)) {
+        PendingRequest *request = value;
+        g_task_return_new_error(request->task, domain, code, "%s", message);
+    }
+}
+
+static gboolean
+on_request_timeout(gpointer user_data)
+{
+    PendingRequest *request = user_data;
+    
+    request->timeout_source = 0;
+    g_task_return_new_error(request->task, G_IO_ERROR, G_IO_ERROR_TIMED_OUT,
+                           "No response from server");
+    
+    PcRemoteConnection *self = g_task_get_source_object(request->task);
+    g_hash_table_remove(self->pending, &request->id);
+    
+    return G_SOURCE_REMOVE;
+}
+
+static void
+complete_request(PcRemoteConnection *self, gint64 id, JsonObject *response)
+{
+    gpointer key, value;
+    
+    if (!g_hash_table_steal_extended(self->pending, &id, &key, &value))
+        return;
+    
+    PendingRequest *request = value;
+    const char *status = json_object_get_string_member_with_default(response, "status", NULL);
+    
+    if (g_strcmp0(status, "error") == 0) {
+        const char *message = json_object_get_string_member_with_default(response, "message",
+                                                                         "Command failed");
+        g_task_return_new_error(request->task, G_IO_ERROR, G_IO_ERROR_FAILED, "%s", message);
+    } else {
+        g_task_return_pointer(request->task, json_object_ref(response),
+                             (GDestroyNotify) json_object_unref);
+    }
+    
+    pending_request_free(request);
+}
+
 static void
 on_message_received(SoupWebsocketConnection *ws,
                    SoupWebsocketDataType type,
                    GBytes *message,
                    PcRemoteConnection *self)
 {
-    if (type != SOUP_WEBSOCKET_DATA_TEXT)
-        return;
-    
     gsize size;
     const char *data = g_bytes_get_data(message, &size);
     
-    g_autoptr(JsonParser) parser = json_parser_new();
-    if (json_parser_load_from_data(parser, data, size, NULL)) {
-        JsonNode *root = json_parser_get_root(parser);
-        JsonObject *obj = json_node_get_object(root);
-        
-        const char *msg_type = json_object_get_string_member(obj, "type");
-        g_print("Received message type: %s\n", msg_type);
-        
-        // Handle different message types here
+    /* Screen frames come as binary messages holding JSON; other binary
+     * messages (audio, clipboard chunks) are not handled here */
+    if (type != SOUP_WEBSOCKET_DATA_TEXT && (size == 0 || data[0] != '{'))
+        return;
+    
+    if ((size > sizeof(frame_prefix) && memcmp(data, frame_prefix, sizeof(frame_prefix) - 1) == 0)
+        || (size > sizeof(refine_prefix) && memcmp(data, refine_prefix, sizeof(refine_prefix) - 1) == 0)
+        || (size > sizeof(update_prefix) && memcmp(data, update_prefix, sizeof(update_prefix) - 1) == 0)) {
+        g_signal_emit(self, signals[SIGNAL_FRAME], 0, message);
+        return;
     }
+    
+    g_autoptr(GError) error = NULL;
+    if (!json_parser_load_from_data(self->parser, data, size, &error)) {
+        g_warning("Received invalid JSON: %s", error->message);
+        return;
+    }
+    
+    JsonNode *root = json_parser_get_root(self->parser);
+    if (!JSON_NODE_HOLDS_OBJECT(root))
+        return;
+    
+    JsonObject *obj = json_node_get_object(root);
+    const char *msg_type = json_object_get_string_member_with_default(obj, "type", "");
+    
+    /* Replies carry the id of the command they answer; anything else,
+     * and replies nobody waits for, go to the views */
+    JsonNode *id_node = json_object_get_member(obj, "id");
+    if (id_node && JSON_NODE_HOLDS_VALUE(id_node)
+        && json_node_get_value_type(id_node) == G_TYPE_INT64) {
+        gint64 id = json_node_get_int(id_node);
+        if (g_hash_table_contains(self->pending, &id)) {
+            complete_request(self, id, obj);
+            return;
+        }
+    }
+    
+    g_signal_emit(self, signals[SIGNAL_MESSAGE], g_quark_try_string(msg_type), msg_type, obj);
 }
 
 static void
@@ -47,6 +178,7 @@ on_websocket_closed(SoupWebsocketConnection *ws,
     g_print("WebSocket connection closed\n");
     self->connected = FALSE;
     g_clear_object(&self->websocket);
+    fail_pending_requests(self, G_IO_ERROR, G_IO_ERROR_CONNECTION_CLOSED, "Connection closed");
 }
 
 static void
@@ -80,11 +212,20 @@ pc_remote_connection_dispose(GObject *object)
     PcRemoteConnection *self = PC_REMOTE_CONNECTION(object);
     
     if (self->websocket) {
+        g_signal_handlers_disconnect_by_data(self->websocket, self);
         soup_websocket_connection_close(self->websocket, SOUP_WEBSOCKET_CLOSE_NORMAL, NULL);
         g_clear_object(&self->websocket);
     }
     
+    if (self->pending) {
+        fail_pending_requests(self, G_IO_ERROR, G_IO_ERROR_CANCELLED, "Connection destroyed");
+        g_clear_pointer(&self->pending, g_hash_table_unref);
+    }
+    
     g_clear_object(&self->session);
+    g_clear_object(&self->builder);
+    g_clear_object(&self->generator);
+    g_clear_object(&self->parser);
     
     G_OBJECT_CLASS(pc_remote_connection_parent_class)->dispose(object);
 }
@@ -94,6 +235,27 @@ pc_remote_connection_class_init(PcRemoteConnectionClass *klass)
 {
     GObjectClass *object_class = G_OBJECT_CLASS(klass);
     object_class->dispose = pc_remote_connection_dispose;
+    
+    /* Emitted for server messages that are not replies to a pending
+     * command, e.g. frames or pushed state; detailed by message type */
+    signals[SIGNAL_MESSAGE] =
+        g_signal_new("message",
+                    G_TYPE_FROM_CLASS(klass),
+                    G_SIGNAL_RUN_LAST | G_SIGNAL_DETAILED,
+                    0, NULL, NULL, NULL,
+                    G_TYPE_NONE, 2,
+                    G_TYPE_STRING,
+                    JSON_TYPE_OBJECT);
+    
+    /* Emitted with the raw, unparsed text of screen frame, update and refine
+     * messages */
+    signals[SIGNAL_FRAME] =
+        g_signal_new("frame",
+                    G_TYPE_FROM_CLASS(klass),
+                    G_SIGNAL_RUN_LAST,
+                    0, NULL, NULL, NULL,
+                    G_TYPE_NONE, 1,
+                    G_TYPE_BYTES);
 }
 
 static void
@@ -101,6 +263,11 @@ pc_remote_connection_init(PcRemoteConnection *self)
 {
     self->session = soup_session_new();
     self->connected = FALSE;
+    self->next_id = 1;
+    self->pending = pending_table_new();
+    self->builder = json_builder_new();
+    self->generator = json_generator_new();
+    self->parser = json_parser_new();
 }
 
 PcRemoteConnection *
@@ -134,11 +301,49 @@ pc_remote_connection_disconnect(PcRemoteConnection *self)
     g_return_if_fail(PC_REMOTE_IS_CONNECTION(self));
     
     if (self->websocket) {
+        g_signal_handlers_disconnect_by_data(self->websocket, self);
         soup_websocket_connection_close(self->websocket, SOUP_WEBSOCKET_CLOSE_NORMAL, NULL);
         g_clear_object(&self->websocket);
     }
     
     self->connected = FALSE;
+    fail_pending_requests(self, G_IO_ERROR, G_IO_ERROR_CONNECTION_CLOSED, "Disconnected");
+}
+
+/* Serializes one command with the shared builder and generator and sends
+ * it. The builder must hold the open command object with its members. */
+static void
+send_built_command(PcRemoteConnection *self)
+{
+    json_builder_end_object(self->builder);
+    
+    JsonNode *root = json_builder_get_root(self->builder);
+    json_generator_set_root(self->generator, root);
+    
+    g_autofree char *json_string = json_generator_to_data(self->generator, NULL);
+    soup_websocket_connection_send_text(self->websocket, json_string);
+    
+    json_node_unref(root);
+    json_builder_reset(self->builder);
+}
+
+static gint64
+begin_command(PcRemoteConnection *self, const char *type, const char *action)
+{
+    gint64 id = self->next_id++;
+    
+    json_builder_begin_object(self->builder);
+    
+    json_builder_set_member_name(self->builder, "type");
+    json_builder_add_string_value(self->builder, type);
+    
+    json_builder_set_member_name(self->builder, "action");
+    json_builder_add_string_value(self->builder, action);
+    
+    json_builder_set_member_name(self->builder, "id");
+    json_builder_add_int_value(self->builder, id);
+    
+    return id;
 }
 
 void
@@ -152,17 +357,10 @@ pc_remote_connection_send_command(PcRemoteConnection *self,
     g_return_if_fail(type != NULL);
     g_return_if_fail(action != NULL);
     
-    JsonBuilder *builder = json_builder_new();
-    json_builder_begin_object(builder);
-    
-    json_builder_set_member_name(builder, "type");
-    json_builder_add_string_value(builder, type);
+    begin_command(self, type, action);
     
-    json_builder_set_member_name(builder, "action");
-    json_builder_add_string_value(builder, action);
-    
-    json_builder_set_member_name(builder, "id");
-    json_builder_add_int_value(builder, g_get_real_time() / 1000);
+    json_builder_set_member_name(self->builder, "noAck");
+    json_builder_add_boolean_value(self->builder, TRUE);
     
     if (data) {
         GHashTableIter iter;
@@ -170,22 +368,73 @@ pc_remote_connection_send_command(PcRemoteConnection *self,
         
         g_hash_table_iter_init(&iter, data);
         while (g_hash_table_iter_next(&iter, &key, &value)) {
-            json_builder_set_member_name(builder, key);
-            json_builder_add_string_value(builder, value);
+            json_builder_set_member_name(self->builder, key);
+            json_builder_add_string_value(self->builder, value);
         }
     }
     
-    json_builder_end_object(builder);
+    send_built_command(self);
+}
+
+void
+pc_remote_connection_send_command_async(PcRemoteConnection *self,
+                                       const char *type,
+                                       const char *action,
+                                       JsonObject *data,
+                                       guint timeout_ms,
+                                       GAsyncReadyCallback callback,
+                                       gpointer user_data)
+{
+    g_return_if_fail(PC_REMOTE_IS_CONNECTION(self));
+    g_return_if_fail(type != NULL);
+    g_return_if_fail(action != NULL);
+    
+    GTask *task = g_task_new(self, NULL, callback, user_data);
+    g_task_set_source_tag(task, pc_remote_connection_send_command_async);
     
-    JsonNode *root = json_builder_get_root(builder);
-    JsonGenerator *gen = json_generator_new();
-    json_generator_set_root(gen, root);
+    if (!self->connected) {
+        g_task_return_new_error(task, G_IO_ERROR, G_IO_ERROR_NOT_CONNECTED, "Not connected");
+        g_object_unref(task);
+        return;
+    }
     
-    g_autofree char *json_string = json_generator_to_data(gen, NULL);
+    PendingRequest *request = g_new0(PendingRequest, 1);
+    request->id = begin_command(self, type, action);
+    request->task = task;
     
-    soup_websocket_connection_send_text(self->websocket, json_string);
+    if (data) {
+        JsonObjectIter iter;
+        const char *name;
+        JsonNode *value;
+        
+        json_object_iter_init(&iter, data);
+        while (json_object_iter_next(&iter, &name, &value)) {
+            json_builder_set_member_name(self->builder, name);
+            json_builder_add_value(self->builder, json_node_copy(value));
+        }
+    }
+    
+    request->timeout_source = g_timeout_add(timeout_ms ? timeout_ms : DEFAULT_TIMEOUT_MS,
+                                           on_request_timeout, request);
+    g_hash_table_insert(self->pending, &request->id, request);
+    
+    send_built_command(self);
+}
+
+JsonObject *
+pc_remote_connection_send_command_finish(PcRemoteConnection *self,
+                                        GAsyncResult *result,
+                                        GError **error)
+{
+    g_return_val_if_fail(g_task_is_valid(result, self), NULL);
+    
+    return g_task_propagate_pointer(G_TASK(result), error);
+}
+
+guint
+pc_remote_connection_get_pending_count(PcRemoteConnection *self)
+{
+    g_return_val_if_fail(PC_REMOTE_IS_CONNECTION(self), 0);
     
-    json_node_free(root);
-    g_object_unref(gen);
-    g_object_unref(builder);
+    return g_hash_table_size(self->pending);
 }
@@ -4,7 +4,8 @@
 #ifndef PC_REMOTE_CONNECTION_H
 #define PC_REMOTE_CONNECTION_H
 
-#include <glib-object.h>
+#include <gio/gio.h>
+#include <json-glib/json-glib.h>
 
 G_BEGIN_DECLS
 
@@ -14,11 +15,29 @@ G_DECLARE_FINAL_TYPE(PcRemoteConnection, pc_remote_connection, PC_REMOTE, CONNEC
 PcRemoteConnection *pc_remote_connection_new(void);
 gboolean pc_remote_connection_connect(PcRemoteConnection *self, const char *address);
 void pc_remote_connection_disconnect(PcRemoteConnection *self);
+
+/* Fire-and-forget: the server only answers if the command fails */
 void pc_remote_connection_send_command(PcRemoteConnection *self, 
                                       const char *type,
                                       const char *action,
                                       GHashTable *data);
 
+/* Sends a command and completes when the server answers it, fails or the
+ * timeout expires (0 for the default). Any number of commands may be in
+ * flight; members of data, if given, are added to the command. */
+void pc_remote_connection_send_command_async(PcRemoteConnection *self,
+                                            const char *type,
+                                            const char *action,
+                                            JsonObject *data,
+                                            guint timeout_ms,
+                                            GAsyncReadyCallback callback,
+                                            gpointer user_data);
+JsonObject *pc_remote_connection_send_command_finish(PcRemoteConnection *self,
+                                                    GAsyncResult *result,
+                                                    GError **error);
+
+guint pc_remote_connection_get_pending_count(PcRemoteConnection *self);
+
 G_END_DECLS
 
 #endif /* PC_REMOTE_CONNECTION_H */
@@ -2,5 +2,623 @@
 // Copyright (C) 2026 Multi-Function PC Remote Contributors
 
 #include "screen_view.h"
+#include <string.h>
 
-// Screen view implementation placeholder
+#ifdef HAVE_TURBOJPEG
+#include <turbojpeg.h>
+#endif
+
+/*
+ * Frames never touch the main loop until they are ready to display:
+ *
+ *   connection "frame" signal -> queue -> decoder thread -> canvas
+ *     -> copy into a pooled buffer -> tick callback -> GdkTexture
+ *
+ * The decoder skips frames that a newer full frame already replaces, and
+ * only the newest decoded frame waits for the display; older ones go back
+ * to the pool and are counted as dropped.
+ */
+
+#define BYTES_PER_PIXEL 4
+#define STATS_INTERVAL_US G_USEC_PER_SEC
+
+/* Buffers handed to textures, returned to the pool when GTK releases them */
+typedef struct
+{
+    GMutex mutex;
+    GPtrArray *free_buffers;
+    gsize buffer_size;
+} FramePool;
+
+typedef struct
+{
+    FramePool *pool;
+    guint8 *data;
+    gsize size;
+} FrameBuffer;
+
+struct _PcRemoteScreenView
+{
+    GtkBox parent_instance;
+    
+    PcRemoteConnection *connection;
+    GtkWidget *toggle_button;
+    GtkWidget *picture;
+    GtkWidget *stats_label;
+    guint tick_id;
+    GdkTexture *texture;
+#if GTK_CHECK_VERSION(4, 16, 0)
+    GdkMemoryTextureBuilder *texture_builder;
+#endif
+    gint64 last_stats_time;
+    
+    /* Decoder thread and its private state */
+    GThread *decoder;
+    GAsyncQueue *queue;
+    JsonParser *parser;
+    GByteArray *scratch;
+    guint8 *canvas;
+    int canvas_width;
+    int canvas_height;
+#ifdef HAVE_TURBOJPEG
+    tjhandle jpeg;
+#endif
+    
+    /* Handed from the decoder to the main loop under the lock */
+    GMutex lock;
+    FramePool *pool;
+    FrameBuffer *latest;
+    int latest_width;
+    int latest_height;
+    cairo_region_t *latest_region; /* Changed since the texture on screen */
+    
+    /* Counters, updated atomically */
+    int frames_received;
+    int frames_skipped;   /* Superseded before being decoded */
+    int frames_decoded;
+    int frames_dropped;   /* Decoded but replaced before being shown */
+    int frames_displayed;
+};
+
+G_DEFINE_TYPE(PcRemoteScreenView, pc_remote_screen_view, GTK_TYPE_BOX)
+
+/* Pushed to the queue to stop the decoder thread */
+static GBytes *stop_marker;
+
+static void
+frame_pool_clear(FramePool *pool)
+{
+    g_ptr_array_unref(pool->free_buffers);
+    g_mutex_clear(&pool->mutex);
+}
+
+static void
+frame_buffer_free(FrameBuffer *buffer)
+{
+    g_free(buffer->data);
+    g_free(buffer);
+}
+
+static FramePool *
+frame_pool_new(void)
+{
+    FramePool *pool = g_atomic_rc_box_new0(FramePool);
+    g_mutex_init(&pool->mutex);
+    pool->free_buffers = g_ptr_array_new_with_free_func((GDestroyNotify) frame_buffer_free);
+    return pool;
+}
+
+static FrameBuffer *
+frame_pool_acquire(FramePool *pool, gsize size)
+{
+    FrameBuffer *buffer = NULL;
+    
+    g_mutex_lock(&pool->mutex);
+    if (pool->buffer_size != size) {
+        /* The frame size changed; buffers of the old size are useless */
+        g_ptr_array_set_size(pool->free_buffers, 0);
+        pool->buffer_size = size;
+    }
+    if (pool->free_buffers->len > 0)
+        buffer = g_ptr_array_steal_index_fast(pool->free_buffers, pool->free_buffers->len - 1);
+    g_mutex_unlock(&pool->mutex);
+    
+    if (!buffer) {
+        buffer = g_new0(FrameBuffer, 1);
+        buffer->data = g_malloc(size);
+        buffer->size = size;
+    }
+    
+    /* Outstanding buffers keep the pool alive after the view is gone */
+    buffer->pool = g_atomic_rc_box_acquire(pool);
+    return buffer;
+}
+
+/* Any thread: GTK drops textures from the render thread as well */
+static void
+frame_buffer_release(FrameBuffer *buffer)
+{
+    FramePool *pool = buffer->pool;
+    
+    g_mutex_lock(&pool->mutex);
+    if (buffer->size == pool->buffer_size) {
+        g_ptr_array_add(pool->free_buffers, buffer);
+        buffer = NULL;
+    }
+    g_mutex_unlock(&pool->mutex);
+    
+    if (buffer)
+        frame_buffer_free(buffer);
+    g_atomic_rc_box_release_full(pool, (GDestroyNotify) frame_pool_clear);
+}
+
+static gboolean
+ensure_canvas(PcRemoteScreenView *self, int width, int height)
+{
+    if (width <= 0 || height <= 0 || width > 16384 || height > 16384)
+        return FALSE;
+    
+    if (self->canvas_width != width || self->canvas_height != height) {
+        g_free(self->canvas);
+        self->canvas = g_malloc0((gsize) width * height * BYTES_PER_PIXEL);
+        self->canvas_width = width;
+        self->canvas_height = height;
+    }
+    return TRUE;
+}
+
+/* Decodes base64 into the reused scratch buffer; returns the length */
+static gsize
+decode_base64(PcRemoteScreenView *self, const char *text)
+{
+    gsize length = strlen(text);
+    
+    g_byte_array_set_size(self->scratch, length + 1);
+    memcpy(self->scratch->data, text, length + 1);
+    g_base64_decode_inplace((char *) self->scratch->data, &length);
+    return length;
+}
+
+/* Decodes a JPEG into the canvas at (x, y). With width and height of 0 the
+ * canvas is first resized to the image. */
+static gboolean
+decode_jpeg(PcRemoteScreenView *self, const guint8 *jpeg, gsize size,
+            int x, int y, gboolean resize_canvas)
+{
+#ifdef HAVE_TURBOJPEG
+    int width, height, subsampling, colorspace;
+    if (tjDecompressHeader3(self->jpeg, jpeg, size, &width, &height, &subsampling, &colorspace) != 0)
+        return FALSE;
+    
+    if (resize_canvas && !ensure_canvas(self, width, height))
+        return FALSE;
+    if (x < 0 || y < 0 || x + width > self->canvas_width || y + height > self->canvas_height)
+        return FALSE;
+    
+    /* Straight into place in the canvas, without an intermediate image */
+    const int stride = self->canvas_width * BYTES_PER_PIXEL;
+    guint8 *destination = self->canvas + (gsize) y * stride + (gsize) x * BYTES_PER_PIXEL;
+    return tjDecompress2(self->jpeg, jpeg, size, destination, width, stride, height,
+                         TJPF_BGRA, TJFLAG_FASTDCT) == 0;
+#else
+    g_autoptr(GdkPixbufLoader) loader = gdk_pixbuf_loader_new_with_type("jpeg", NULL);
+    if (!loader || !gdk_pixbuf_loader_write(loader, jpeg, size, NULL)
+        || !gdk_pixbuf_loader_close(loader, NULL))
+        return FALSE;
+    
+    GdkPixbuf *pixbuf = gdk_pixbuf_loader_get_pixbuf(loader);
+    const int width = gdk_pixbuf_get_width(pixbuf);
+    const int height = gdk_pixbuf_get_height(pixbuf);
+    
+    if (resize_canvas && !ensure_canvas(self, width, height))
+        return FALSE;
+    if (x < 0 || y < 0 || x + width > self->canvas_width || y + height > self->canvas_height)
+        return FALSE;
+    
+    const int channels = gdk_pixbuf_get_n_channels(pixbuf);
+    const int source_stride = gdk_pixbuf_get_rowstride(pixbuf);
+    const guint8 *source = gdk_pixbuf_read_pixels(pixbuf);
+    const int stride = self->canvas_width * BYTES_PER_PIXEL;
+    
+    for (int row = 0; row < height; row++) {
+        const guint8 *in = source + (gsize) row * source_stride;
+        guint8 *out = self->canvas + (gsize) (y + row) * stride + (gsize) x * BYTES_PER_PIXEL;
+        for (int column = 0; column < width; column++, in += channels, out += BYTES_PER_PIXEL) {
+            out[0] = in[2];
+            out[1] = in[1];
+            out[2] = in[0];
+            out[3] = 0xff;
+        }
+    }
+    return TRUE;
+#endif
+}
+
+static gboolean
+is_full_frame(GBytes *message)
+{
+    static const char prefix[] = "{\"type\":\"screen\",\"action\":\"frame\"";
+    gsize size;
+    const char *data = g_bytes_get_data(message, &size);
+    
+    return size > sizeof(prefix) && memcmp(data, prefix, sizeof(prefix) - 1) == 0;
+}
+
+/* Decodes one frame, update or refine message into the canvas and adds the
+ * area it covered to region */
+static gboolean
+decode_message(PcRemoteScreenView *self, GBytes *message, cairo_region_t *region)
+{
+    gsize size;
+    const char *data = g_bytes_get_data(message, &size);
+    
+    if (!json_parser_load_from_data(self->parser, data, size, NULL))
+        return FALSE;
+    
+    JsonObject *obj = json_node_get_object(json_parser_get_root(self->parser));
+    const char *action = json_object_get_string_member_with_default(obj, "action", "");
+    
+    if (g_str_equal(action, "refine") || g_str_equal(action, "update")) {
+        /* An area that changed, or a sharper copy of one that stopped
+         * changing */
+        const char *encoded = json_object_get_string_member_with_default(obj, "data", NULL);
+        const int x = json_object_get_int_member_with_default(obj, "x", 0);
+        const int y = json_object_get_int_member_with_default(obj, "y", 0);
+        if (!encoded || !self->canvas)
+            return FALSE;
+        
+        gsize length = decode_base64(self, encoded);
+        if (!decode_jpeg(self, self->scratch->data, length, x, y, FALSE))
+            return FALSE;
+        
+        cairo_rectangle_int_t area = {
+            x, y,
+            json_object_get_int_member_with_default(obj, "width", 0),
+            json_object_get_int_member_with_default(obj, "height", 0)
+        };
+        cairo_region_union_rectangle(region, &area);
+        return TRUE;
+    }
+    
+    if (json_object_has_member(obj, "stripes")) {
+        /* A frame split into horizontal stripes, each its own JPEG */
+        if (!ensure_canvas(self, json_object_get_int_member_with_default(obj, "width", 0),
+                           json_object_get_int_member_with_default(obj, "height", 0)))
+            return FALSE;
+        
+        JsonArray *stripes = json_object_get_array_member(obj, "stripes");
+        const guint count = stripes ? json_array_get_length(stripes) : 0;
+        for (guint i = 0; i < count; i++) {
+            JsonObject *stripe = json_array_get_object_element(stripes, i);
+            const char *encoded = json_object_get_string_member_with_default(stripe, "data", NULL);
+            if (!encoded)
+                return FALSE;
+            
+            gsize length = decode_base64(self, encoded);
+            if (!decode_jpeg(self, self->scratch->data, length, 0,
+                             json_object_get_int_member_with_default(stripe, "y", 0), FALSE))
+                return FALSE;
+        }
+    } else {
+        const char *encoded = json_object_get_string_member_with_default(obj, "data", NULL);
+        if (!encoded)
+            return FALSE;
+        
+        gsize length = decode_base64(self, encoded);
+        if (!decode_jpeg(self, self->scratch->data, length, 0, 0, TRUE))
+            return FALSE;
+    }
+    
+    cairo_rectangle_int_t all = { 0, 0, self->canvas_width, self->canvas_height };
+    cairo_region_union_rectangle(region, &all);
+    return TRUE;
+}
+
+static void
+publish_canvas(PcRemoteScreenView *self, cairo_region_t *region)
+{
+    const gsize size = (gsize) self->canvas_width * self->canvas_height * BYTES_PER_PIXEL;
+    FrameBuffer *buffer = frame_pool_acquire(self->pool, size);
+    memcpy(buffer->data, self->canvas, size);
+    
+    g_mutex_lock(&self->lock);
+    FrameBuffer *replaced = self->latest;
+    if (self->latest_width != self->canvas_width || self->latest_height != self->canvas_height) {
+        cairo_region_destroy(self->latest_region);
+        self->latest_region = cairo_region_create();
+    }
+    self->latest = buffer;
+    self->latest_width = self->canvas_width;
+    self->latest_height = self->canvas_height;
+    /* A replaced frame was never shown, so its changes still count */
+    cairo_region_union(self->latest_region, region);
+    g_mutex_unlock(&self->lock);
+    
+    if (replaced) {
+        frame_buffer_release(replaced);
+        g_atomic_int_inc(&self->frames_dropped);
+    }
+}
+
+static gpointer
+decoder_thread(gpointer user_data)
+{
+    PcRemoteScreenView *self = user_data;
+    GPtrArray *batch = g_ptr_array_new_with_free_func((GDestroyNotify) g_bytes_unref);
+    cairo_region_t *region = cairo_region_create();
+    
+    for (;;) {
+        GBytes *message = g_async_queue_pop(self->queue);
+        gboolean stop = message == stop_marker;
+        
+        /* Take everything that is waiting so a backlog is skipped, not
+         * worked through */
+        while (!stop && message) {
+            g_ptr_array_add(batch, message);
+            message = g_async_queue_try_pop(self->queue);
+            stop = message == stop_marker;
+        }
+        if (stop) {
+            g_bytes_unref(message);
+            break;
+        }
+        
+        /* Everything before the newest full frame is painted over by it */
+        guint first = 0;
+        for (guint i = batch->len; i > 0; i--) {
+            if (is_full_frame(g_ptr_array_index(batch, i - 1))) {
+                first = i - 1;
+                break;
+            }
+        }
+        if (first > 0)
+            g_atomic_int_add(&self->frames_skipped, (int) first);
+        
+        gboolean decoded = FALSE;
+        for (guint i = first; i < batch->len; i++) {
+            if (decode_message(self, g_ptr_array_index(batch, i), region)) {
+                decoded = TRUE;
+                g_atomic_int_inc(&self->frames_decoded);
+            }
+        }
+        g_ptr_array_set_size(batch, 0);
+        
+        if (decoded) {
+            publish_canvas(self, region);
+            cairo_region_destroy(region);
+            region = cairo_region_create();
+        }
+    }
+    
+    cairo_region_destroy(region);
+    g_ptr_array_unref(batch);
+    return NULL;
+}
+
+static void
+on_frame(PcRemoteConnection *connection, GBytes *message, PcRemoteScreenView *self)
+{
+    g_atomic_int_inc(&self->frames_received);
+    g_async_queue_push(self->queue, g_bytes_ref(message));
+}
+
+static void
+update_stats(PcRemoteScreenView *self)
+{
+    g_autofree char *text = g_strdup_printf("%d received · %d decoded · %d shown · "
+                                            "%d skipped · %d dropped",
+                                            g_atomic_int_get(&self->frames_received),
+                                            g_atomic_int_get(&self->frames_decoded),
+                                            self->frames_displayed,
+                                            g_atomic_int_get(&self->frames_skipped),
+                                            g_atomic_int_get(&self->frames_dropped));
+    gtk_label_set_text(GTK_LABEL(self->stats_label), text);
+}
+
+static gboolean
+on_tick(GtkWidget *widget, GdkFrameClock *frame_clock, gpointer user_data)
+{
+    PcRemoteScreenView *self = user_data;
+    
+    g_mutex_lock(&self->lock);
+    FrameBuffer *buffer = g_steal_pointer(&self->latest);
+    const int width = self->latest_width;
+    const int height = self->latest_height;
+    cairo_region_t *region = self->latest_region;
+    self->latest_region = cairo_region_create();
+    g_mutex_unlock(&self->lock);
+    
+    if (buffer) {
+        const gsize stride = (gsize) width * BYTES_PER_PIXEL;
+        g_autoptr(GBytes) bytes = g_bytes_new_with_free_func(buffer->data, buffer->size,
+                                                             (GDestroyNotify) frame_buffer_release,
+                                                             buffer);
+        GdkTexture *texture;
+#if GTK_CHECK_VERSION(4, 16, 0)
+        /* Based on the previous texture, GTK only uploads the changed area */
+        GdkMemoryTextureBuilder *builder = self->texture_builder;
+        gboolean same_size = self->texture
+            && gdk_texture_get_width(self->texture) == width
+            && gdk_texture_get_height(self->texture) == height;
+        gdk_memory_texture_builder_set_bytes(builder, bytes);
+        gdk_memory_texture_builder_set_stride(builder, stride);
+        gdk_memory_texture_builder_set_width(builder, width);
+        gdk_memory_texture_builder_set_height(builder, height);
+        gdk_memory_texture_builder_set_format(builder, GDK_MEMORY_B8G8R8A8_PREMULTIPLIED);
+        gdk_memory_texture_builder_set_update_texture(builder, same_size ? self->texture : NULL);
+        gdk_memory_texture_builder_set_update_region(builder, same_size ? region : NULL);
+        texture = gdk_memory_texture_builder_build(builder);
+        /* Let go of the frame so its buffer can be recycled */
+        gdk_memory_texture_builder_set_bytes(builder, NULL);
+        gdk_memory_texture_builder_set_update_texture(builder, NULL);
+#else
+        texture = gdk_memory_texture_new(width, height, GDK_MEMORY_B8G8R8A8_PREMULTIPLIED,
+                                         bytes, stride);
+#endif
+        gtk_picture_set_paintable(GTK_PICTURE(self->picture), GDK_PAINTABLE(texture));
+        g_clear_object(&self->texture);
+        self->texture = texture;
+        self->frames_displayed++;
+    }
+    cairo_region_destroy(region);
+    
+    gint64 now = gdk_frame_clock_get_frame_time(frame_clock);
+    if (now - self->last_stats_time >= STATS_INTERVAL_US) {
+        self->last_stats_time = now;
+        update_stats(self);
+    }
+    
+    return G_SOURCE_CONTINUE;
+}
+
+static void
+on_start_finished(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+    g_autoptr(PcRemoteScreenView) self = user_data;
+    g_autoptr(GError) error = NULL;
+    g_autoptr(JsonObject) response =
+        pc_remote_connection_send_command_finish(PC_REMOTE_CONNECTION(source), result, &error);
+    
+    if (error) {
+        g_warning("Failed to start screen sharing: %s", error->message);
+        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(self->toggle_button), FALSE);
+    }
+}
+
+static void
+on_toggled(GtkToggleButton *button, PcRemoteScreenView *self)
+{
+    if (gtk_toggle_button_get_active(button)) {
+        if (self->tick_id)
+            return;
+        
+        /* Refinements are cheap to apply here, so ask for them */
+        g_autoptr(JsonObject) options = json_object_new();
+        json_object_set_boolean_member(options, "progressive", TRUE);
+        pc_remote_connection_send_command_async(self->connection, "screen", "start", options, 0,
+                                               on_start_finished, g_object_ref(self));
+        
+        self->tick_id = gtk_widget_add_tick_callback(self->picture, on_tick, self, NULL);
+        gtk_button_set_label(GTK_BUTTON(button), "Stop");
+    } else {
+        if (!self->tick_id)
+            return;
+        
+        pc_remote_connection_send_command(self->connection, "screen", "stop", NULL);
+        gtk_widget_remove_tick_callback(self->picture, self->tick_id);
+        self->tick_id = 0;
+        update_stats(self);
+        gtk_button_set_label(GTK_BUTTON(button), "Start");
+    }
+}
+
+static void
+pc_remote_screen_view_dispose(GObject *object)
+{
+    PcRemoteScreenView *self = PC_REMOTE_SCREEN_VIEW(object);
+    
+    if (self->decoder) {
+        g_async_queue_push(self->queue, g_bytes_ref(stop_marker));
+        g_thread_join(g_steal_pointer(&self->decoder));
+    }
+    
+    if (self->tick_id) {
+        gtk_widget_remove_tick_callback(self->picture, self->tick_id);
+        self->tick_id = 0;
+    }
+    
+    g_clear_object(&self->connection);
+    g_clear_object(&self->texture);
+#if GTK_CHECK_VERSION(4, 16, 0)
+    g_clear_object(&self->texture_builder);
+#endif
+    
+    G_OBJECT_CLASS(pc_remote_screen_view_parent_class)->dispose(object);
+}
+
+static void
+pc_remote_screen_view_finalize(GObject *object)
+{
+    PcRemoteScreenView *self = PC_REMOTE_SCREEN_VIEW(object);
+    
+    if (self->latest)
+        frame_buffer_release(self->latest);
+    cairo_region_destroy(self->latest_region);
+    g_atomic_rc_box_release_full(self->pool, (GDestroyNotify) frame_pool_clear);
+    g_mutex_clear(&self->lock);
+    
+    g_async_queue_unref(self->queue);
+    g_object_unref(self->parser);
+    g_byte_array_unref(self->scratch);
+    g_free(self->canvas);
+#ifdef HAVE_TURBOJPEG
+    tjDestroy(self->jpeg);
+#endif
+    
+    G_OBJECT_CLASS(pc_remote_screen_view_parent_class)->finalize(object);
+}
+
+static void
+pc_remote_screen_view_class_init(PcRemoteScreenViewClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+    object_class->dispose = pc_remote_screen_view_dispose;
+    object_class->finalize = pc_remote_screen_view_finalize;
+    
+    stop_marker = g_bytes_new_static("", 0);
+}
+
+static void
+pc_remote_screen_view_init(PcRemoteScreenView *self)
+{
+    gtk_orientable_set_orientation(GTK_ORIENTABLE(self), GTK_ORIENTATION_VERTICAL);
+    gtk_box_set_spacing(GTK_BOX(self), 12);
+    gtk_widget_set_margin_top(GTK_WIDGET(self), 12);
+    gtk_widget_set_margin_bottom(GTK_WIDGET(self), 12);
+    gtk_widget_set_margin_start(GTK_WIDGET(self), 12);
+    gtk_widget_set_margin_end(GTK_WIDGET(self), 12);
+    
+    self->picture = gtk_picture_new();
+    gtk_picture_set_content_fit(GTK_PICTURE(self->picture), GTK_CONTENT_FIT_CONTAIN);
+    gtk_widget_set_vexpand(self->picture, TRUE);
+    gtk_box_append(GTK_BOX(self), self->picture);
+    
+    GtkWidget *controls = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 12);
+    self->toggle_button = gtk_toggle_button_new_with_label("Start");
+    g_signal_connect(self->toggle_button, "toggled", G_CALLBACK(on_toggled), self);
+    gtk_box_append(GTK_BOX(controls), self->toggle_button);
+    
+    self->stats_label = gtk_label_new(NULL);
+    gtk_widget_add_css_class(self->stats_label, "dim-label");
+    gtk_widget_set_hexpand(self->stats_label, TRUE);
+    gtk_label_set_xalign(GTK_LABEL(self->stats_label), 1.0);
+    gtk_box_append(GTK_BOX(controls), self->stats_label);
+    gtk_box_append(GTK_BOX(self), controls);
+    
+#if GTK_CHECK_VERSION(4, 16, 0)
+    self->texture_builder = gdk_memory_texture_builder_new();
+#endif
+    
+    g_mutex_init(&self->lock);
+    self->pool = frame_pool_new();
+    self->latest_region = cairo_region_create();
+    self->queue = g_async_queue_new_full((GDestroyNotify) g_bytes_unref);
+    self->parser = json_parser_new();
+    self->scratch = g_byte_array_new();
+#ifdef HAVE_TURBOJPEG
+    self->jpeg = tjInitDecompress();
+#endif
+    self->decoder = g_thread_new("screen-decoder", decoder_thread, self);
+}
+
+GtkWidget *
+pc_remote_screen_view_new(PcRemoteConnection *connection)
+{
+    g_return_val_if_fail(PC_REMOTE_IS_CONNECTION(connection), NULL);
+    
+    PcRemoteScreenView *self = g_object_new(PC_REMOTE_TYPE_SCREEN_VIEW, NULL);
+    self->connection = g_object_ref(connection);
+    g_signal_connect_object(connection, "frame", G_CALLBACK(on_frame), self, 0);
+    
+    return GTK_WIDGET(self);
+}
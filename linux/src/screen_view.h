@@ -5,7 +5,15 @@
 #define PC_REMOTE_SCREEN_VIEW_H
 
 #include <gtk/gtk.h>
+#include "connection.h"
 
-// Screen view functions will be implemented here
+G_BEGIN_DECLS
+
+#define PC_REMOTE_TYPE_SCREEN_VIEW (pc_remote_screen_view_get_type())
+G_DECLARE_FINAL_TYPE(PcRemoteScreenView, pc_remote_screen_view, PC_REMOTE, SCREEN_VIEW, GtkBox)
+
+GtkWidget *pc_remote_screen_view_new(PcRemoteConnection *connection);
+
+G_END_DECLS
 
 #endif /* PC_REMOTE_SCREEN_VIEW_H */
@@ -3,6 +3,7 @@
 
 #include "window.h"
 #include "connection.h"
+#include "screen_view.h"
 
 struct _PcRemoteWindow
 {
@@ -130,7 +131,7 @@ create_controls_page(PcRemoteWindow *self)
                         gtk_label_new("System Commands"),
                         "system", "System");
     gtk_stack_add_titled(self->control_stack,
-                        gtk_label_new("Screen Sharing"),
+                        pc_remote_screen_view_new(self->connection),
                         "screen", "Screen");
     
     gtk_box_append(GTK_BOX(box), switcher);